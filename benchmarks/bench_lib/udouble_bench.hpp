@@ -0,0 +1,239 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// udouble_bench.hpp: This file includes the microbenchmarks shared by the
+// uncertainty classes.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Microbenchmarks shared by every uncertainty model.  Each model's file
+// registers them for its classes with UNCERTAIN_BENCHMARK_UDOUBLE().
+// The operands go through benchmark::DoNotOptimize() in every iteration so
+// that the compiler cannot fold the operation on a known value.
+
+namespace uncertain_bench {
+
+// Starts a new epoch for the classes that track their sources, so that
+// each benchmark sees only the sources it makes itself.
+template <class UD>
+auto reset_sources(int) -> decltype(UD::new_epoch()) {
+  UD::new_epoch();
+}
+
+template <class UD>
+void reset_sources(long) {}
+
+template <class UD>
+void reset_sources() {
+  reset_sources<UD>(0);
+}
+
+// A value with the given mean that depends on num_sources independent
+// sources of uncertainty, with 1% uncertainty overall.
+template <class UD>
+UD make_value(double val, size_t num_sources) {
+  UD sum(val);
+  for (size_t i = 0; i < num_sources; i++)
+    sum += UD(0.0, 0.01 * val / std::sqrt(static_cast<double>(num_sources)));
+  return sum;
+}
+
+// Constructing values with uncertainty, which registers a new source
+// in the classes that track sources.
+template <class UD>
+void BM_Construct(benchmark::State &state) {
+  reset_sources<UD>();
+  size_t count = 0;
+  for (auto _ : state) {
+    UD x(1.0, 0.1);
+    benchmark::DoNotOptimize(x);
+    // keep the source tables of the tracking classes small
+    if (++count % 4096 == 0) reset_sources<UD>();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <class UD>
+void BM_Copy(benchmark::State &state) {
+  reset_sources<UD>();
+  UD a = make_value<UD>(0.5, state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a);
+    UD copy(a);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <class UD, class Op>
+void BM_Unary(benchmark::State &state) {
+  reset_sources<UD>();
+  UD a = make_value<UD>(0.5, 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a);
+    UD r = Op{}(a);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The operands depend on state.range(0) sources each, half of which
+// they share.
+template <class UD, class Op>
+void BM_Binary(benchmark::State &state) {
+  reset_sources<UD>();
+  size_t num_sources = state.range(0);
+  UD shared = make_value<UD>(0.0, num_sources / 2);
+  UD a = make_value<UD>(0.5, num_sources - num_sources / 2) + shared;
+  UD b = make_value<UD>(1.5, num_sources - num_sources / 2) + shared;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(b);
+    UD r = Op{}(a, b);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Summing state.range(0) independent values, the typical way a value
+// comes to depend on many sources.
+template <class UD>
+void BM_SumSources(benchmark::State &state) {
+  reset_sources<UD>();
+  std::vector<UD> terms;
+  for (int64_t i = 0; i < state.range(0); i++) terms.emplace_back(1.0, 0.1);
+  for (auto _ : state) {
+    UD sum;
+    for (const auto &term : terms) sum += term;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+struct negate_op {
+  template <class T>
+  auto operator()(const T &x) const {
+    return -x;
+  }
+};
+
+#define UNCERTAIN_BENCH_OP2(name, op)                                                              \
+  struct name##_op {                                                                               \
+    template <class T>                                                                             \
+    auto operator()(const T &x, const T &y) const {                                                \
+      return x op y;                                                                               \
+    }                                                                                              \
+  };
+UNCERTAIN_BENCH_OP2(add, +)
+UNCERTAIN_BENCH_OP2(sub, -)
+UNCERTAIN_BENCH_OP2(mul, *)
+UNCERTAIN_BENCH_OP2(div, /)
+#undef UNCERTAIN_BENCH_OP2
+
+#define UNCERTAIN_BENCH_FUNC1(name)                                                                \
+  struct name##_op {                                                                               \
+    template <class T>                                                                             \
+    auto operator()(const T &x) const {                                                            \
+      return name(x);                                                                              \
+    }                                                                                              \
+  };
+#define UNCERTAIN_BENCH_FUNC2(name)                                                                \
+  struct name##_op {                                                                               \
+    template <class T>                                                                             \
+    auto operator()(const T &x, const T &y) const {                                                \
+      return name(x, y);                                                                           \
+    }                                                                                              \
+  };
+UNCERTAIN_BENCH_FUNC1(sqrt)
+UNCERTAIN_BENCH_FUNC1(sin)
+UNCERTAIN_BENCH_FUNC1(cos)
+UNCERTAIN_BENCH_FUNC1(tan)
+UNCERTAIN_BENCH_FUNC1(asin)
+UNCERTAIN_BENCH_FUNC1(acos)
+UNCERTAIN_BENCH_FUNC1(atan)
+UNCERTAIN_BENCH_FUNC1(ceil)
+UNCERTAIN_BENCH_FUNC1(floor)
+UNCERTAIN_BENCH_FUNC1(fabs)
+UNCERTAIN_BENCH_FUNC1(exp)
+UNCERTAIN_BENCH_FUNC1(log)
+UNCERTAIN_BENCH_FUNC1(log10)
+UNCERTAIN_BENCH_FUNC1(sinh)
+UNCERTAIN_BENCH_FUNC1(cosh)
+UNCERTAIN_BENCH_FUNC1(tanh)
+UNCERTAIN_BENCH_FUNC2(fmod)
+UNCERTAIN_BENCH_FUNC2(atan2)
+UNCERTAIN_BENCH_FUNC2(pow)
+#undef UNCERTAIN_BENCH_FUNC1
+#undef UNCERTAIN_BENCH_FUNC2
+
+}  // namespace uncertain_bench
+
+// source counts for the benchmarks that take one
+#define UNCERTAIN_BENCH_SOURCES RangeMultiplier(4)->Range(1, 256)
+
+// Registers every benchmark above for the class UD.
+#define UNCERTAIN_BENCHMARK_UDOUBLE(UD)                                                            \
+  namespace uncertain_bench {                                                                      \
+  BENCHMARK_TEMPLATE(BM_Construct, UD);                                                            \
+  BENCHMARK_TEMPLATE(BM_Copy, UD)->UNCERTAIN_BENCH_SOURCES;                                        \
+  BENCHMARK_TEMPLATE(BM_SumSources, UD)->UNCERTAIN_BENCH_SOURCES;                                  \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, negate_op);                                                     \
+  BENCHMARK_TEMPLATE(BM_Binary, UD, add_op)->UNCERTAIN_BENCH_SOURCES;                              \
+  BENCHMARK_TEMPLATE(BM_Binary, UD, sub_op)->UNCERTAIN_BENCH_SOURCES;                              \
+  BENCHMARK_TEMPLATE(BM_Binary, UD, mul_op)->UNCERTAIN_BENCH_SOURCES;                              \
+  BENCHMARK_TEMPLATE(BM_Binary, UD, div_op)->UNCERTAIN_BENCH_SOURCES;                              \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, sqrt_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, sin_op);                                                        \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, cos_op);                                                        \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, tan_op);                                                        \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, asin_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, acos_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, atan_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, ceil_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, floor_op);                                                      \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, fabs_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, exp_op);                                                        \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, log_op);                                                        \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, log10_op);                                                      \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, sinh_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, cosh_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Unary, UD, tanh_op);                                                       \
+  BENCHMARK_TEMPLATE(BM_Binary, UD, fmod_op)->Arg(2);                                              \
+  BENCHMARK_TEMPLATE(BM_Binary, UD, atan2_op)->Arg(2);                                             \
+  BENCHMARK_TEMPLATE(BM_Binary, UD, pow_op)->Arg(2);                                               \
+  }
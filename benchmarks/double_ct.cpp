@@ -0,0 +1,64 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// double_ct.cpp: This file includes the benchmarks of the correlation
+// tracking classes UDoubleCT<> for each component array.
+
+#include <uncertain/double_ct.hpp>
+#include <uncertain/scaled_array.hpp>
+#include <uncertain/simple_array.hpp>
+#include <uncertain/small_array.hpp>
+#include <uncertain/sparse_array.hpp>
+
+#include "bench_lib/udouble_bench.hpp"
+
+using UDoubleCTSA = uncertain::UDoubleCT<uncertain::SimpleArray>;
+using UDoubleCTAA = uncertain::UDoubleCT<uncertain::ScaledArray>;
+using UDoubleCTSparse = uncertain::UDoubleCT<uncertain::SparseArray>;
+using UDoubleCTSmall = uncertain::UDoubleCT<uncertain::SmallArray<8>>;
+
+template <>
+uncertain::SourceSet UDoubleCTSA::sources("Simple Array");
+
+template <>
+uncertain::SourceSet UDoubleCTAA::sources("Scaled Array");
+
+template <>
+uncertain::SourceSet UDoubleCTSparse::sources("Sparse Array");
+
+template <>
+uncertain::SourceSet UDoubleCTSmall::sources("Small Array");
+
+UNCERTAIN_BENCHMARK_UDOUBLE(UDoubleCTSA)
+UNCERTAIN_BENCHMARK_UDOUBLE(UDoubleCTAA)
+UNCERTAIN_BENCHMARK_UDOUBLE(UDoubleCTSparse)
+UNCERTAIN_BENCHMARK_UDOUBLE(UDoubleCTSmall)
@@ -0,0 +1,61 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// double_ensemble.cpp: This file includes the benchmarks of the ensemble
+// classes UDoubleEnsemble<> for several ensemble sizes.
+
+#include <uncertain/double_ensemble.hpp>
+
+#include "bench_lib/udouble_bench.hpp"
+
+using Ensemble16 = uncertain::UDoubleEnsemble<16>;
+using Ensemble256 = uncertain::UDoubleEnsemble<256>;
+using Ensemble1024 = uncertain::UDoubleEnsemble<1024>;
+using Ensemble4096 = uncertain::UDoubleEnsemble<4096>;
+
+#define UNCERTAIN_BENCH_ENSEMBLE_STATICS(UD)                                                       \
+  template <>                                                                                      \
+  uncertain::SourceSet UD::sources(#UD);                                                           \
+  template <>                                                                                      \
+  std::vector<std::vector<double>> UD::src_ensemble = {};                                          \
+  template <>                                                                                      \
+  std::vector<double> UD::gauss_ensemble = {};
+UNCERTAIN_BENCH_ENSEMBLE_STATICS(Ensemble16)
+UNCERTAIN_BENCH_ENSEMBLE_STATICS(Ensemble256)
+UNCERTAIN_BENCH_ENSEMBLE_STATICS(Ensemble1024)
+UNCERTAIN_BENCH_ENSEMBLE_STATICS(Ensemble4096)
+#undef UNCERTAIN_BENCH_ENSEMBLE_STATICS
+
+UNCERTAIN_BENCHMARK_UDOUBLE(Ensemble16)
+UNCERTAIN_BENCHMARK_UDOUBLE(Ensemble256)
+UNCERTAIN_BENCHMARK_UDOUBLE(Ensemble1024)
+UNCERTAIN_BENCHMARK_UDOUBLE(Ensemble4096)
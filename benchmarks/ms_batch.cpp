@@ -0,0 +1,82 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ms_batch.cpp: This file includes the benchmarks of the batch class
+// UDoubleMSBatch<> against loops over UDoubleMS<>.
+
+#include <uncertain/ms_batch.hpp>
+#include <vector>
+
+#include "bench_lib/udouble_bench.hpp"
+
+using uncertain::UDoubleMSUncorr;
+using uncertain::UDoubleMSUncorrBatch;
+
+// a * b + sin(a) over state.range(0) values, as a loop over UDoubleMS
+static void BM_MSLoop(benchmark::State &state) {
+  size_t n = state.range(0);
+  std::vector<UDoubleMSUncorr> a(n, UDoubleMSUncorr(0.5, 0.01)), b(n, UDoubleMSUncorr(1.5, 0.02));
+  std::vector<UDoubleMSUncorr> r(n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; i++) r[i] = a[i] * b[i] + sin(a[i]);
+    benchmark::DoNotOptimize(r.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// the same with batch operators
+static void BM_MSBatch(benchmark::State &state) {
+  size_t n = state.range(0);
+  UDoubleMSUncorrBatch a(n, 0.5, 0.01), b(n, 1.5, 0.02);
+  for (auto _ : state) {
+    auto r = a * b + sin(a);
+    benchmark::DoNotOptimize(r.means().data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// the same in one pass with transform()
+static void BM_MSBatchTransform(benchmark::State &state) {
+  size_t n = state.range(0);
+  UDoubleMSUncorrBatch a(n, 0.5, 0.01), b(n, 1.5, 0.02);
+  for (auto _ : state) {
+    auto r = transform(a, b, [](const UDoubleMSUncorr &x, const UDoubleMSUncorr &y) {
+      return x * y + sin(x);
+    });
+    benchmark::DoNotOptimize(r.means().data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_MSLoop)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK(BM_MSBatch)->RangeMultiplier(16)->Range(1 << 8, 1 << 20)->UseRealTime();
+BENCHMARK(BM_MSBatchTransform)->RangeMultiplier(16)->Range(1 << 8, 1 << 20)->UseRealTime();
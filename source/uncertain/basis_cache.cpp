@@ -0,0 +1,171 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// basis_cache.cpp: This file includes the lookup of the Gaussian basis of
+// the ensemble classes in the tables built with the library and in the
+// on-disk cache.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <uncertain/ensemble_basis.hpp>
+
+namespace uncertain {
+
+namespace {
+
+const char kMagic[8] = {'U', 'N', 'C', 'B', 'A', 'S', 'I', 'S'};
+
+// FNV-1a over the bytes of the samples, to catch truncated and damaged files
+uint64_t checksum(const std::vector<double> &basis) {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(basis.data());
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < basis.size() * sizeof(double); i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+struct CacheDir {
+  std::mutex mutex;
+  bool overridden = false;
+  std::string dir;
+};
+
+CacheDir &cache_dir() {
+  static CacheDir dir;
+  return dir;
+}
+
+}  // namespace
+
+std::string gauss_basis_cache_dir() {
+  {
+    CacheDir &dir = cache_dir();
+    std::lock_guard<std::mutex> lock(dir.mutex);
+    if (dir.overridden) return dir.dir;
+  }
+  if (const char *env = std::getenv("UNCERTAIN_CACHE_DIR")) return env;
+  return {};
+}
+
+void set_gauss_basis_cache_dir(const std::string &dir) {
+  CacheDir &cache = cache_dir();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.overridden = true;
+  cache.dir = dir;
+}
+
+std::string gauss_basis_cache_file(const std::string &dir, size_t n) {
+  return dir + "/gauss_basis_v" + std::to_string(kGaussBasisVersion) + "_" + std::to_string(n) +
+         ".bin";
+}
+
+bool read_gauss_basis_file(const std::string &path, size_t n, std::vector<double> &basis) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+
+  char magic[sizeof(kMagic)];
+  uint32_t version = 0;
+  uint64_t size = 0;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char *>(&version), sizeof(version));
+  file.read(reinterpret_cast<char *>(&size), sizeof(size));
+  if (!file || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || version != kGaussBasisVersion ||
+      size != n)
+    return false;
+
+  std::vector<double> values(n);
+  uint64_t sum = 0;
+  file.read(reinterpret_cast<char *>(values.data()), n * sizeof(double));
+  file.read(reinterpret_cast<char *>(&sum), sizeof(sum));
+  if (!file || file.peek() != std::ifstream::traits_type::eof() || sum != checksum(values))
+    return false;
+
+  basis = std::move(values);
+  return true;
+}
+
+bool write_gauss_basis_file(const std::string &path, const std::vector<double> &basis) {
+  namespace fs = std::filesystem;
+  std::error_code error;
+  fs::path target(path);
+  if (target.has_parent_path()) fs::create_directories(target.parent_path(), error);
+
+  // written under a unique name, then renamed over the target in one step
+  fs::path temporary = target;
+  temporary += "." + std::to_string(std::random_device{}()) + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    uint32_t version = kGaussBasisVersion;
+    uint64_t size = basis.size();
+    uint64_t sum = checksum(basis);
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char *>(basis.data()), basis.size() * sizeof(double));
+    file.write(reinterpret_cast<const char *>(&sum), sizeof(sum));
+    file.close();
+    if (!file) {
+      fs::remove(temporary, error);
+      return false;
+    }
+  }
+  fs::rename(temporary, target, error);
+  if (error) {
+    fs::remove(temporary, error);
+    return false;
+  }
+  return true;
+}
+
+std::vector<double> make_gauss_basis(size_t n) {
+  if (const double *table = precomputed_gauss_basis(n))
+    return std::vector<double>(table, table + n);
+
+  std::string dir = gauss_basis_cache_dir();
+  std::vector<double> basis;
+  if (!dir.empty() && read_gauss_basis_file(gauss_basis_cache_file(dir, n), n, basis))
+    return basis;
+
+  basis = compute_gauss_basis(n);
+  // the cache only saves time; a read-only or missing home changes nothing
+  if (!dir.empty()) write_gauss_basis_file(gauss_basis_cache_file(dir, n), basis);
+  return basis;
+}
+
+}  // namespace uncertain
@@ -0,0 +1,134 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// correlation.cpp: This file includes the correlations of the samples of
+// ensembles at every offset, computed with fast Fourier transforms.
+
+#include <cmath>
+#include <uncertain/correlation.hpp>
+#include <uncertain/kernels.hpp>
+#include <utility>
+
+namespace uncertain {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// iterative radix-2 transform, n a power of two
+void fft_radix2(std::complex<double> *x, size_t n, bool inverse) {
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) std::swap(x[i], x[j]);
+  }
+
+  // each twiddle factor is computed directly rather than by repeated
+  // multiplication, so the rounding errors do not grow with n
+  const double sign = inverse ? 1.0 : -1.0;
+  std::vector<std::complex<double>> twiddle(n / 2);
+  for (size_t k = 0; k < n / 2; k++) twiddle[k] = std::polar(1.0, sign * 2 * kPi * k / n);
+
+  for (size_t len = 2; len <= n; len <<= 1) {
+    const size_t half = len / 2, stride = n / len;
+    for (size_t start = 0; start < n; start += len) {
+      for (size_t k = 0; k < half; k++) {
+        std::complex<double> u = x[start + k];
+        std::complex<double> v = x[start + k + half] * twiddle[k * stride];
+        x[start + k] = u + v;
+        x[start + k + half] = u - v;
+      }
+    }
+  }
+}
+
+// Bluestein's algorithm: the transform as a convolution with a chirp,
+// done with radix-2 transforms of at least 2n - 1 values
+void fft_bluestein(std::complex<double> *x, size_t n, bool inverse) {
+  size_t m = 1;
+  while (m < 2 * n - 1) m <<= 1;
+
+  // k^2 is reduced modulo 2n so the angle stays accurate for large k
+  const double sign = inverse ? 1.0 : -1.0;
+  std::vector<std::complex<double>> chirp(n);
+  for (size_t k = 0; k < n; k++)
+    chirp[k] = std::polar(1.0, sign * kPi * double((k * k) % (2 * n)) / n);
+
+  std::vector<std::complex<double>> a(m), b(m);
+  for (size_t k = 0; k < n; k++) a[k] = x[k] * chirp[k];
+  b[0] = std::conj(chirp[0]);
+  for (size_t k = 1; k < n; k++) b[k] = b[m - k] = std::conj(chirp[k]);
+
+  fft_radix2(a.data(), m, false);
+  fft_radix2(b.data(), m, false);
+  for (size_t k = 0; k < m; k++) a[k] *= b[k];
+  fft_radix2(a.data(), m, true);
+  for (size_t k = 0; k < n; k++) x[k] = chirp[k] * a[k] / double(m);
+}
+
+}  // namespace
+
+void fft(std::complex<double> *x, size_t n, bool inverse) {
+  if (n < 2) return;
+  if ((n & (n - 1)) == 0)
+    fft_radix2(x, n, inverse);
+  else
+    fft_bluestein(x, n, inverse);
+}
+
+std::vector<double> lag_correlations(const double *a, const double *b, size_t n) {
+  std::vector<double> retval(n, 0.0);
+  if (n == 0) return retval;
+
+  // Rotating b changes neither its mean nor its spread, so only the sums
+  // of products depend on the offset: the circular cross-correlation of
+  // the centered arrays, conj(A) B in the frequency domain.
+  CoMomentSums sums = vec_comoment_sums(a, b, n);
+  if (!sums.m2_a || !sums.m2_b) return retval;
+
+  std::vector<std::complex<double>> fa(n), fb(n);
+  for (size_t i = 0; i < n; i++) {
+    fa[i] = a[i] - sums.mean_a;
+    fb[i] = b[i] - sums.mean_b;
+  }
+  fft(fa.data(), n);
+  fft(fb.data(), n);
+  for (size_t k = 0; k < n; k++) fa[k] = std::conj(fa[k]) * fb[k];
+  fft(fa.data(), n, true);
+
+  const double norm = 1.0 / (n * std::sqrt(sums.m2_a * sums.m2_b));
+  for (size_t k = 0; k < n; k++) retval[k] = fa[k].real() * norm;
+  return retval;
+}
+
+}  // namespace uncertain
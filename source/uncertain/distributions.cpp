@@ -0,0 +1,136 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// distributions.cpp: This file includes the quantile functions of the
+// distributions in distributions.hpp and the cache of their bases.
+
+#include <cmath>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <uncertain/distributions.hpp>
+#include <uncertain/ensemble_basis.hpp>
+#include <uncertain/kernels.hpp>
+#include <utility>
+
+namespace uncertain {
+
+namespace {
+
+// the probability of a standard normal deviate below x, and above it
+double normal_cdf(double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); }
+double normal_ccdf(double x) { return 0.5 * std::erfc(x / std::sqrt(2.0)); }
+
+constexpr size_t kBasisCacheCapacity = 64;
+
+struct BasisCache {
+  using Key = std::pair<DistributionShape, size_t>;
+  std::mutex mutex;
+  std::map<Key, std::shared_ptr<const std::vector<double>>> bases;
+  std::deque<Key> order;  // oldest first
+};
+
+BasisCache &basis_cache() {
+  static BasisCache cache;
+  return cache;
+}
+
+}  // namespace
+
+void standard_quantiles(const DistributionShape &shape, double *p, size_t n) {
+  switch (shape.kind) {
+    case DistributionShape::uniform:
+      break;
+    case DistributionShape::triangular: {
+      double c = shape.a;
+      for (size_t i = 0; i < n; i++)
+        p[i] = p[i] < c ? std::sqrt(p[i] * c) : 1.0 - std::sqrt((1.0 - p[i]) * (1.0 - c));
+      break;
+    }
+    case DistributionShape::lognormal:
+      vec_inverse_normal_cdf(p, n);
+      vec_mul(p, shape.a, n);
+      vec_exp(p, n);
+      break;
+    case DistributionShape::truncated_normal: {
+      // Work from whichever tail the interval is nearer, where the
+      // probabilities are small and keep their precision.
+      if (shape.a > 0.0) {
+        double upper = normal_ccdf(shape.a), width = upper - normal_ccdf(shape.b);
+        for (size_t i = 0; i < n; i++) p[i] = upper - p[i] * width;
+        vec_inverse_normal_cdf(p, n);
+        vec_negate(p, n);
+      } else {
+        double lower = normal_cdf(shape.a), width = normal_cdf(shape.b) - lower;
+        for (size_t i = 0; i < n; i++) p[i] = lower + p[i] * width;
+        vec_inverse_normal_cdf(p, n);
+      }
+      break;
+    }
+  }
+}
+
+std::shared_ptr<const std::vector<double>> quantile_basis(const DistributionShape &shape,
+                                                          size_t n) {
+  BasisCache &cache = basis_cache();
+  BasisCache::Key key(shape, n);
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto found = cache.bases.find(key);
+    if (found != cache.bases.end()) return found->second;
+  }
+
+  std::vector<double> basis;
+  if (shape.kind == DistributionShape::lognormal) {
+    // from the perfected Gaussian basis, so the logs have exact moments
+    basis = make_gauss_basis(n);
+    vec_mul(basis.data(), shape.a, n);
+    vec_exp(basis.data(), n);
+  } else {
+    basis.resize(n);
+    for (size_t i = 0; i < n; i++) basis[i] = (i + 0.5) / n;
+    standard_quantiles(shape, basis.data(), n);
+  }
+  auto shared = std::make_shared<const std::vector<double>>(std::move(basis));
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto inserted = cache.bases.emplace(key, shared);
+  if (!inserted.second) return inserted.first->second;  // made on another thread meanwhile
+  cache.order.push_back(key);
+  if (cache.order.size() > kBasisCacheCapacity) {
+    cache.bases.erase(cache.order.front());
+    cache.order.pop_front();
+  }
+  return shared;
+}
+
+}  // namespace uncertain
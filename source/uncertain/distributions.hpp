@@ -0,0 +1,157 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// distributions.hpp: This file includes the non-Gaussian distributions the
+// ensemble classes can make new sources of uncertainty from.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace uncertain {
+
+// The shape of a distribution: its kind and the parameters that are left
+// once it is shifted and scaled to a standard form.  Distributions of the
+// same shape share one basis of quantiles.
+struct DistributionShape {
+  enum Kind { uniform, triangular, lognormal, truncated_normal };
+
+  Kind kind;
+  double a = 0.0;
+  double b = 0.0;
+
+  bool operator<(const DistributionShape &other) const {
+    if (kind != other.kind) return kind < other.kind;
+    if (a != other.a) return a < other.a;
+    return b < other.b;
+  }
+};
+
+// the default name of a source of uncertainty with a distribution
+inline std::string distribution_name(const char *kind, std::initializer_list<double> params) {
+  std::ostringstream os;
+  os << "anon " << kind << "(";
+  const char *separator = "";
+  for (double param : params) {
+    os << separator << param;
+    separator = ", ";
+  }
+  os << ")";
+  return os.str();
+}
+
+// Each distribution is offset() + scale() times the standard distribution
+// of its shape().
+
+// uniform on [low, high]
+struct Uniform {
+  double low, high;
+
+  Uniform(double low, double high) : low(low), high(high) {
+    if (!(low < high)) throw std::runtime_error("Uniform distribution needs low < high");
+  }
+
+  DistributionShape shape() const { return {DistributionShape::uniform}; }
+  double offset() const { return low; }
+  double scale() const { return high - low; }
+  std::string name() const { return distribution_name("uniform", {low, high}); }
+};
+
+// triangular on [low, high], peaked at mode
+struct Triangular {
+  double low, mode, high;
+
+  Triangular(double low, double mode, double high) : low(low), mode(mode), high(high) {
+    if (!(low <= mode && mode <= high && low < high))
+      throw std::runtime_error("Triangular distribution needs low <= mode <= high, low < high");
+  }
+
+  DistributionShape shape() const {
+    return {DistributionShape::triangular, (mode - low) / (high - low)};
+  }
+  double offset() const { return low; }
+  double scale() const { return high - low; }
+  std::string name() const { return distribution_name("triangular", {low, mode, high}); }
+};
+
+// exp(x) for x normal with mean mu and deviation sigma
+struct Lognormal {
+  double mu, sigma;
+
+  Lognormal(double mu, double sigma) : mu(mu), sigma(sigma) {
+    if (!(sigma > 0.0)) throw std::runtime_error("Lognormal distribution needs sigma > 0");
+  }
+
+  DistributionShape shape() const { return {DistributionShape::lognormal, sigma}; }
+  double offset() const { return 0.0; }
+  double scale() const { return std::exp(mu); }
+  std::string name() const { return distribution_name("lognormal", {mu, sigma}); }
+};
+
+// normal with the given mean and deviation, cut to [low, high]
+struct TruncatedNormal {
+  double mean, deviation, low, high;
+
+  TruncatedNormal(double mean, double deviation, double low, double high)
+      : mean(mean), deviation(deviation), low(low), high(high) {
+    if (!(deviation > 0.0 && low < high))
+      throw std::runtime_error("TruncatedNormal distribution needs deviation > 0, low < high");
+  }
+
+  DistributionShape shape() const {
+    return {DistributionShape::truncated_normal, (low - mean) / deviation,
+            (high - mean) / deviation};
+  }
+  double offset() const { return mean; }
+  double scale() const { return deviation; }
+  std::string name() const {
+    return distribution_name("truncated normal", {mean, deviation, low, high});
+  }
+};
+
+// Replaces each probability p[i] with the quantile of the standard
+// distribution of the shape at p[i].
+void standard_quantiles(const DistributionShape &shape, double *p, size_t n);
+
+// The n samples of the standard distribution of the shape, one for each
+// slice of equal probability, made once and then shared.  The last few
+// dozen shapes asked for are kept.
+std::shared_ptr<const std::vector<double>> quantile_basis(const DistributionShape &shape, size_t n);
+
+}  // namespace uncertain
@@ -36,8 +36,8 @@
 
 #pragma once
 
-#include <functional>
 #include <uncertain/source_set.hpp>
+#include <utility>
 
 namespace uncertain {
 
@@ -52,6 +52,17 @@ class UDoubleCT {
   size_t epoch;
   static SourceSet sources;
 
+  // returns slope * r + other_slope * other with the given value, reusing the storage of r
+  static UDoubleCT linear(UDoubleCT r, double slope, const UDoubleCT &other, double other_slope,
+                          double val) {
+    sources.check_epoch(r.epoch);
+    sources.check_epoch(other.epoch);
+    if (slope != 1.0) r.unc_components *= slope;
+    r.unc_components.add_scaled(other.unc_components, other_slope);
+    r.value = val;
+    return r;
+  }
+
  public:
   // default constructor creates a new independent uncertainty element
   UDoubleCT(double val = 0.0, double unc = 0.0, const std::string &name = {}) : value(val) {
@@ -69,7 +80,7 @@ class UDoubleCT {
         uncertain_print(val, unc, os);
         source_name = os.str();
       }
-      size_t new_source_num = sources.get_new_source(source_name);
+      size_t new_source_num = sources.get_new_source(source_name, epoch);
       unc_components.set_element(new_source_num, unc);
     }
   }
@@ -77,7 +88,11 @@ class UDoubleCT {
   // copy constructor does not create a new independent uncertainty element
   UDoubleCT(const UDoubleCT &ud) = default;
 
-  // \todo operator= ?
+  UDoubleCT(UDoubleCT &&ud) noexcept = default;
+
+  UDoubleCT &operator=(const UDoubleCT &ud) = default;
+
+  UDoubleCT &operator=(UDoubleCT &&ud) noexcept = default;
 
   ~UDoubleCT() = default;
 
@@ -101,9 +116,11 @@ class UDoubleCT {
     os << std::endl;
   }
 
-  UDoubleCT operator+() const { return *this; }
+  UDoubleCT operator+() const & { return *this; }
+
+  UDoubleCT operator+() && { return std::move(*this); }
 
-  UDoubleCT operator-() const {
+  UDoubleCT operator-() const & {
     UDoubleCT retval;
 
     retval.value = -value;
@@ -111,6 +128,13 @@ class UDoubleCT {
     return retval;
   }
 
+  // negates a temporary in place, keeping its components' storage
+  UDoubleCT operator-() && {
+    value = -value;
+    unc_components *= -1.0;
+    return std::move(*this);
+  }
+
   UDoubleCT &operator+=(const UDoubleCT &b) {
     sources.check_epoch(epoch);
     sources.check_epoch(b.epoch);
@@ -124,7 +148,20 @@ class UDoubleCT {
     return *this;
   }
 
-  friend UDoubleCT operator+(UDoubleCT a, const UDoubleCT &b) { return a += b; }
+  // Binary operators reuse the components of a temporary operand and add the
+  // other operand's components scaled by its slope in one pass.  Expressions
+  // are not fused: each operator makes its own passes over the components, and
+  // one whose operands are both named values copies one of them first, so
+  // a*b + c/d - e makes two component arrays.
+  friend UDoubleCT operator+(UDoubleCT a, const UDoubleCT &b) {
+    double val = a.value + b.value;
+    return linear(std::move(a), 1.0, b, 1.0, val);
+  }
+
+  friend UDoubleCT operator+(const UDoubleCT &a, UDoubleCT &&b) {
+    double val = a.value + b.value;
+    return linear(std::move(b), 1.0, a, 1.0, val);
+  }
 
   friend UDoubleCT operator+(UDoubleCT a, double b) { return a += b; }
 
@@ -143,13 +180,21 @@ class UDoubleCT {
     return *this;
   }
 
-  friend UDoubleCT operator-(UDoubleCT a, const UDoubleCT &b) { return a -= b; }
+  friend UDoubleCT operator-(UDoubleCT a, const UDoubleCT &b) {
+    double val = a.value - b.value;
+    return linear(std::move(a), 1.0, b, -1.0, val);
+  }
+
+  friend UDoubleCT operator-(const UDoubleCT &a, UDoubleCT &&b) {
+    double val = a.value - b.value;
+    return linear(std::move(b), -1.0, a, 1.0, val);
+  }
 
   friend UDoubleCT operator-(UDoubleCT a, double b) { return a -= b; }
 
   friend UDoubleCT operator-(double b, UDoubleCT a) {
     a -= b;
-    return -a;
+    return -std::move(a);
   }
 
   UDoubleCT &operator*=(const UDoubleCT &b) {
@@ -167,9 +212,9 @@ class UDoubleCT {
     return *this;
   }
 
-  UDoubleCT operator++() { return (*this += 1.0); }
+  UDoubleCT &operator++() { return (*this += 1.0); }
 
-  UDoubleCT operator--() { return (*this -= 1.0); }
+  UDoubleCT &operator--() { return (*this -= 1.0); }
 
   UDoubleCT operator++(int) {
     UDoubleCT retval(*this);
@@ -183,7 +228,15 @@ class UDoubleCT {
     return retval;
   }
 
-  friend UDoubleCT operator*(UDoubleCT a, const UDoubleCT &b) { return a *= b; }
+  friend UDoubleCT operator*(UDoubleCT a, const UDoubleCT &b) {
+    double va = a.value, vb = b.value;
+    return linear(std::move(a), vb, b, va, va * vb);
+  }
+
+  friend UDoubleCT operator*(const UDoubleCT &a, UDoubleCT &&b) {
+    double va = a.value, vb = b.value;
+    return linear(std::move(b), va, a, vb, va * vb);
+  }
 
   friend UDoubleCT operator*(UDoubleCT a, double b) { return a *= b; }
 
@@ -204,16 +257,23 @@ class UDoubleCT {
     return *this;
   }
 
-  friend UDoubleCT operator/(UDoubleCT a, const UDoubleCT &b) { return a /= b; }
+  friend UDoubleCT operator/(UDoubleCT a, const UDoubleCT &b) {
+    double va = a.value, vb = b.value;
+    return linear(std::move(a), 1.0 / vb, b, -va / (vb * vb), va / vb);
+  }
 
-  friend UDoubleCT operator/(UDoubleCT a, double b) { return a /= b; }
+  friend UDoubleCT operator/(const UDoubleCT &a, UDoubleCT &&b) {
+    double va = a.value, vb = b.value;
+    return linear(std::move(b), -va / (vb * vb), a, 1.0 / vb, va / vb);
+  }
 
-  friend UDoubleCT operator/(const double a, const UDoubleCT &b) {
-    UDoubleCT retval(0.0);
+  friend UDoubleCT operator/(UDoubleCT a, double b) { return a /= b; }
 
-    retval.unc_components = b.unc_components * (-a / (b.value * b.value));
-    retval.value = a / b.value;
-    return retval;
+  friend UDoubleCT operator/(const double a, UDoubleCT b) {
+    double vb = b.value;
+    b.unc_components *= -a / (vb * vb);
+    b.value = a / vb;
+    return b;
   }
 
   friend std::ostream &operator<<(std::ostream &os, const UDoubleCT &ud) {
@@ -234,67 +294,68 @@ class UDoubleCT {
     return is;
   }
 
-  static UDoubleCT func1(std::function<one_arg_ret(double)> func_w_moments, UDoubleCT arg) {
+  template <class Func>
+  static UDoubleCT func1(Func func_w_moments, UDoubleCT arg) {
     one_arg_ret funcret = func_w_moments(arg.value);
     arg.value = funcret.value;
     arg.unc_components *= funcret.arg.slope;
     return arg;
   }
 
-  static UDoubleCT func2(std::function<two_arg_ret(double, double)> func_w_moments,
-                         const UDoubleCT &arg1, const UDoubleCT &arg2) {
+  template <class Func>
+  static UDoubleCT func2(Func func_w_moments, const UDoubleCT &arg1, const UDoubleCT &arg2) {
     UDoubleCT<T>::sources.check_epoch(arg1.epoch);
     UDoubleCT<T>::sources.check_epoch(arg2.epoch);
     UDoubleCT retval(arg1);
     two_arg_ret funcret = func_w_moments(arg1.value, arg2.value);
     retval.value = funcret.value;
-    retval.unc_components =
-        arg1.unc_components * funcret.arg1.slope + arg2.unc_components * funcret.arg2.slope;
+    retval.unc_components *= funcret.arg1.slope;
+    retval.unc_components.add_scaled(arg2.unc_components, funcret.arg2.slope);
     return retval;
   }
 
-  friend UDoubleCT sqrt(UDoubleCT arg) { return func1(&sqrt_w_moments, arg); }
+  friend UDoubleCT sqrt(UDoubleCT arg) { return func1(sqrt_w_moments_tag{}, arg); }
 
-  friend UDoubleCT sin(UDoubleCT arg) { return func1(&sin_w_moments, arg); }
+  friend UDoubleCT sin(UDoubleCT arg) { return func1(sin_w_moments_tag{}, arg); }
 
-  friend UDoubleCT cos(UDoubleCT arg) { return func1(&cos_w_moments, arg); }
+  friend UDoubleCT cos(UDoubleCT arg) { return func1(cos_w_moments_tag{}, arg); }
 
-  friend UDoubleCT tan(UDoubleCT arg) { return func1(&tan_w_moments, arg); }
+  friend UDoubleCT tan(UDoubleCT arg) { return func1(tan_w_moments_tag{}, arg); }
 
-  friend UDoubleCT asin(UDoubleCT arg) { return func1(&asin_w_moments, arg); }
+  friend UDoubleCT asin(UDoubleCT arg) { return func1(asin_w_moments_tag{}, arg); }
 
-  friend UDoubleCT acos(UDoubleCT arg) { return func1(&acos_w_moments, arg); }
+  friend UDoubleCT acos(UDoubleCT arg) { return func1(acos_w_moments_tag{}, arg); }
 
-  friend UDoubleCT atan(UDoubleCT arg) { return func1(&atan_w_moments, arg); }
+  friend UDoubleCT atan(UDoubleCT arg) { return func1(atan_w_moments_tag{}, arg); }
 
-  friend UDoubleCT ceil(UDoubleCT arg) { return func1(&ceil_w_moments, arg); }
+  friend UDoubleCT ceil(UDoubleCT arg) { return func1(ceil_w_moments_tag{}, arg); }
 
-  friend UDoubleCT floor(UDoubleCT arg) { return func1(&floor_w_moments, arg); }
+  friend UDoubleCT floor(UDoubleCT arg) { return func1(floor_w_moments_tag{}, arg); }
 
-  friend UDoubleCT fabs(UDoubleCT arg) { return func1(&fabs_w_moments, arg); }
+  friend UDoubleCT fabs(UDoubleCT arg) { return func1(fabs_w_moments_tag{}, arg); }
 
-  friend UDoubleCT exp(UDoubleCT arg) { return func1(&exp_w_moments, arg); }
+  friend UDoubleCT exp(UDoubleCT arg) { return func1(exp_w_moments_tag{}, arg); }
 
-  friend UDoubleCT log(UDoubleCT arg) { return func1(&log_w_moments, arg); }
+  friend UDoubleCT log(UDoubleCT arg) { return func1(log_w_moments_tag{}, arg); }
 
-  friend UDoubleCT log10(UDoubleCT arg) { return func1(&log10_w_moments, arg); }
+  friend UDoubleCT log10(UDoubleCT arg) { return func1(log10_w_moments_tag{}, arg); }
 
-  friend UDoubleCT sinh(UDoubleCT arg) { return func1(&sinh_w_moments, arg); }
+  friend UDoubleCT sinh(UDoubleCT arg) { return func1(sinh_w_moments_tag{}, arg); }
 
-  friend UDoubleCT cosh(UDoubleCT arg) { return func1(&cosh_w_moments, arg); }
+  friend UDoubleCT cosh(UDoubleCT arg) { return func1(cosh_w_moments_tag{}, arg); }
 
-  friend UDoubleCT tanh(UDoubleCT arg) { return func1(&tanh_w_moments, arg); }
+  friend UDoubleCT tanh(UDoubleCT arg) { return func1(tanh_w_moments_tag{}, arg); }
 
   friend UDoubleCT fmod(const UDoubleCT &arg1, const UDoubleCT &arg2) {
-    return func2(&fmod_w_moments, arg1, arg2);
+    return func2(fmod_w_moments_tag{}, arg1, arg2);
   }
 
   friend UDoubleCT atan2(const UDoubleCT &arg1, const UDoubleCT &arg2) {
-    return func2(&atan2_w_moments, arg1, arg2);
+    return func2(atan2_w_moments_tag{}, arg1, arg2);
   }
 
   friend UDoubleCT pow(const UDoubleCT &arg1, const UDoubleCT &arg2) {
-    return func2(&pow_w_moments, arg1, arg2);
+    return func2(pow_w_moments_tag{}, arg1, arg2);
   }
 
   friend UDoubleCT ldexp(UDoubleCT arg, const int intarg) {
@@ -0,0 +1,274 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// double_ensemble.cpp: This file includes the parts of the ensemble
+// uncertainty classes that do not depend on the ensemble size.
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <uncertain/double_ensemble.hpp>
+
+namespace uncertain {
+
+void make_recipe_samples(const EnsembleSourceRecipe &recipe, size_t source_num, size_t n,
+                         const double *gauss, double *x) {
+  Xoshiro256 engine(recipe.seed, source_num);
+  bool gaussian = recipe.kind == EnsembleSourceRecipe::gaussian;
+  if (recipe.sampling == EnsembleSampling::shuffled_basis) {
+    std::shared_ptr<const std::vector<double>> basis;
+    if (!gaussian) basis = quantile_basis(recipe.shape, n);
+    const double *standard = gaussian ? gauss : basis->data();
+    for (size_t i = 0; i < n; i++) x[i] = recipe.offset + standard[i] * recipe.scale;
+    shuffle_values(x, n, engine);
+    return;
+  }
+
+  if (recipe.sampling == EnsembleSampling::latin_hypercube)
+    latin_hypercube_uniforms(x, n, engine);
+  else
+    sobol_uniforms(x, n, source_num, recipe.seed);
+  if (gaussian)
+    vec_inverse_normal_cdf(x, n);
+  else
+    standard_quantiles(recipe.shape, x, n);
+  vec_mul(x, recipe.scale, n);
+  vec_add(x, recipe.offset, n);
+}
+
+EnsembleAttribution attribute_samples(const double *x, size_t n, double mean, size_t num_sources,
+                                      const std::function<bool(size_t, double *)> &source_samples,
+                                      const SourceSet &sources) {
+  EnsembleAttribution retval;
+  std::vector<double> centered(n);
+  double sum = 0.0, square = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    centered[i] = x[i] - mean;
+    sum += centered[i];
+    square += centered[i] * centered[i];
+  }
+  const double m2 = square - sum * sum / n;
+  if (!(m2 > 0.0)) return retval;
+
+  std::vector<double> correlations(num_sources, 0.0);
+  std::vector<char> tracked(num_sources, 0);
+  constexpr size_t kBlock = 4;
+  const size_t min_chunk = std::max<size_t>(kBlock, (size_t(1) << 16) / n);
+  parallel_for(num_sources, min_chunk, [&](size_t begin, size_t end) {
+    std::vector<double> block(kBlock * n);
+    const double *rows[kBlock];
+    size_t numbers[kBlock];
+    ProjectionSums sums[kBlock];
+    for (size_t i = begin; i < end;) {
+      size_t count = 0;
+      for (; i < end && count < kBlock; i++) {
+        double *row = block.data() + count * n;
+        if (!source_samples(i, row)) continue;
+        rows[count] = row;
+        numbers[count++] = i;
+      }
+      vec_projection_sums(centered.data(), rows, count, n, sums);
+      for (size_t r = 0; r < count; r++) {
+        double m2_source = sums[r].square - sums[r].sum * sums[r].sum / n;
+        double c = sums[r].cross - sum * sums[r].sum / n;
+        tracked[numbers[r]] = 1;
+        if (m2_source > 0.0 && c != 0.0) correlations[numbers[r]] = c / std::sqrt(m2 * m2_source);
+      }
+    }
+  });
+
+  for (size_t i = 0; i < num_sources; i++) {
+    if (!tracked[i]) continue;
+    double portion = correlations[i] * correlations[i];
+    retval.sources.push_back({i, sources.get_source_name(i), correlations[i], portion});
+    retval.other -= portion;
+  }
+  return retval;
+}
+
+void ensemble_apply(void (*kernel)(double *, size_t), double *a, size_t n, size_t threshold) {
+  if (n < threshold) return kernel(a, n);
+  parallel_for(n, kEnsembleMinChunk,
+               [=](size_t begin, size_t end) { kernel(a + begin, end - begin); });
+}
+
+void ensemble_apply(void (*kernel)(double *, const double *, size_t), double *a, const double *b,
+                    size_t n, size_t threshold) {
+  if (n < threshold) return kernel(a, b, n);
+  parallel_for(n, kEnsembleMinChunk,
+               [=](size_t begin, size_t end) { kernel(a + begin, b + begin, end - begin); });
+}
+
+void ensemble_apply(void (*kernel)(double *, double, size_t), double *a, double b, size_t n,
+                    size_t threshold) {
+  if (n < threshold) return kernel(a, b, n);
+  parallel_for(n, kEnsembleMinChunk,
+               [=](size_t begin, size_t end) { kernel(a + begin, b, end - begin); });
+}
+
+MomentSums ensemble_moment_sums(const double *x, size_t n, size_t threshold) {
+  if (n < threshold) return vec_moment_sums(x, n);
+  // fixed blocks rather than the chunks of the threads, so the sums are
+  // merged the same way however many threads there are
+  size_t num_blocks = (n + kEnsembleMinChunk - 1) / kEnsembleMinChunk;
+  std::vector<MomentSums> blocks(num_blocks);
+  parallel_for(num_blocks, 1, [&](size_t begin, size_t end) {
+    for (size_t b = begin; b < end; b++) {
+      size_t start = b * kEnsembleMinChunk;
+      blocks[b] = vec_moment_sums(x + start, std::min(kEnsembleMinChunk, n - start));
+    }
+  });
+  MomentSums retval;
+  for (const MomentSums &block : blocks) retval.merge(block);
+  return retval;
+}
+
+EnsembleStats ensemble_stats(const MomentSums &sums) {
+  double power_sums[5] = {0.0, sums.m2, sums.m3, sums.m4, sums.m5};
+  EnsembleStats retval;
+  retval.mean = sums.mean;
+  moments_from_sums(size_t(sums.count), power_sums, retval.deviation, retval.skew,
+                    retval.kurtosis, retval.m5);
+  return retval;
+}
+
+CoMomentSums ensemble_comoment_sums(const double *a, const double *b, size_t n, size_t offset) {
+  if (n == 0) return {};
+  offset %= n;
+  CoMomentSums sums = vec_comoment_sums(a, b + offset, n - offset);
+  sums.merge(vec_comoment_sums(a + n - offset, b, offset));
+  return sums;
+}
+
+double ensemble_correlation(const double *a, const double *b, size_t n, size_t offset) {
+  CoMomentSums sums = ensemble_comoment_sums(a, b, n, offset);
+  if (!sums.m2_a || !sums.m2_b || !sums.c) return 0.0;
+  return sums.c / std::sqrt(sums.m2_a * sums.m2_b);
+}
+
+double ensemble_covariance(const double *a, const double *b, size_t n, size_t offset) {
+  if (n == 0) return 0.0;
+  return ensemble_comoment_sums(a, b, n, offset).c / n;
+}
+
+Histogram ensemble_histogram(const double *x, size_t n, double low, double high, size_t bins) {
+  Histogram retval(low, high, bins);
+  retval.add(x, n);
+  return retval;
+}
+
+std::vector<double> ensemble_quantiles(const double *x, size_t n,
+                                       const std::vector<double> &probabilities) {
+  std::vector<double> copy(x, x + n);
+  return sample_quantiles(copy.data(), copy.size(), probabilities);
+}
+
+std::pair<double, double> ensemble_credible_interval(const double *x, size_t n,
+                                                     double probability) {
+  std::vector<double> limits =
+      ensemble_quantiles(x, n, {(1.0 - probability) / 2, (1.0 + probability) / 2});
+  return {limits[0], limits[1]};
+}
+
+void print_ensemble_stats(const EnsembleStats &stats, std::ostream &os) {
+  uncertain_print(stats.mean, stats.deviation, os);
+
+  if (stats.deviation != 0.0) {
+    auto original_precision = os.precision();
+    auto original_format = os.flags(std::ios::showpoint);
+    os << std::setprecision(2) << " [" << stats.skew << " : " << stats.kurtosis << " : "
+       << stats.m5 << "]" << std::setprecision(original_precision);
+    os.flags(original_format);
+  }
+}
+
+void print_ensemble_sources(double deviation, const std::function<EnsembleAttribution()> &attribute,
+                            std::ostream &os) {
+  if (deviation == 0.0)
+    os << "No uncertainty";
+  else {
+    EnsembleAttribution attribution = attribute();
+    for (const EnsembleAttribution::Source &source : attribution.sources)
+      os << source.name << ": " << int_percent(source.portion) << "%" << std::endl;
+    os << "other: " << int_percent(attribution.other) << "%" << std::endl;
+  }
+  os << std::endl;
+}
+
+void print_ensemble_histogram(const double *x, size_t n, const EnsembleStats &stats,
+                              std::ostream &os) {
+  // centered bins for each 0.5 sigmas from -4 sigmas to +4 sigmas
+  // outliers go in the outer bins
+  int bin[17];
+  int i;
+  double value = stats.mean;
+  double sigma = stats.deviation;
+
+  if (sigma == 0.0) {
+    os << "No histogram when no uncertainty" << std::endl;
+    return;
+  }
+  Histogram counts = ensemble_histogram(x, n, value - 4.25 * sigma, value + 4.25 * sigma, 17);
+  for (i = 0; i < 17; i++) bin[i] = int(counts.count(i));
+  bin[0] += int(counts.below());
+  bin[16] += int(counts.above());
+  int binmax = 1;
+  for (i = 0; i < 17; i++)
+    if (bin[i] >= binmax) binmax = bin[i];
+  int scale_divisor = 1;
+  while (binmax / scale_divisor > 74) scale_divisor++;
+  os << "Histogram:  (each * represents ";
+  if (scale_divisor == 1)
+    os << "1 point)";
+  else
+    os << scale_divisor << " points)";
+  os << setiosflags(std::ios::showpos) << std::endl;
+  int bin_display[17];  // number of characters displayed in each bin
+  for (i = 0; i < 17; i++) {
+    bin_display[i] = int((bin[i] + 0.5) / scale_divisor);
+  }
+  int first_display_bin = 0, last_display_bin = 16;
+  while (bin_display[first_display_bin] == 0) first_display_bin++;
+  while (bin_display[last_display_bin] == 0) last_display_bin--;
+  for (i = first_display_bin; i <= last_display_bin; i++) {
+    if (i & 1)
+      os << "    | ";
+    else
+      os << std::setw(3) << (i / 2 - 4) << " + ";
+    for (int j = 0; j < bin_display[i]; j++) os << "*";
+    os << std::endl;
+  }
+  os << resetiosflags(std::ios::showpos) << std::endl;
+}
+
+}  // namespace uncertain
@@ -34,17 +34,31 @@
 // and supporting classes and functions.
 // By Evan Manning (manning@alumni.caltech.edu).
 
-// Warning: this file contains an object (UDoubleInit) to insure that
-// srand() gets called exactly once to seed the random number
-// generator.  But this may cause problems if used with source
-// code that already calls srand() and/or uses that family of
-// random number generators in any files that don't #include this file.
+// The ensembles are shuffled with the generators of random.hpp, never
+// with rand(), so they do not disturb code that uses the C library's
+// random numbers.
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <uncertain/correlation.hpp>
+#include <uncertain/distributions.hpp>
+#include <uncertain/ensemble_basis.hpp>
+#include <uncertain/ensemble_storage.hpp>
+#include <uncertain/histogram.hpp>
+#include <uncertain/kernels.hpp>
+#include <uncertain/parallel.hpp>
+#include <uncertain/random.hpp>
+#include <uncertain/sampling.hpp>
 #include <uncertain/source_set.hpp>
+#include <utility>
 #include <vector>
 
 // \todo get rid of this include
@@ -52,6 +66,182 @@
 
 namespace uncertain {
 
+// The statistics of the samples of an ensemble.  The skew, kurtosis
+// (excess over a normal distribution) and m5 are the standardized 3rd,
+// 4th and 5th central moments.
+struct EnsembleStats {
+  double mean = 0.0;
+  double deviation = 0.0;
+  double skew = 0.0;
+  double kurtosis = 0.0;
+  double m5 = 0.0;
+};
+
+// The share of the variance of an ensemble due to each tracked source of
+// uncertainty, from UDoubleEnsemble<>::attribute_sources().
+struct EnsembleAttribution {
+  struct Source {
+    size_t number;       // the source number
+    std::string name;
+    double correlation;  // of the ensemble with the source's samples
+    double portion;      // correlation^2
+  };
+
+  std::vector<Source> sources;  // by source number
+  double other = 1.0;           // the share not due to any tracked source
+};
+
+// The statistics of an ensemble, computed when first asked for and kept
+// until invalidate() is called because the samples changed.  Reading is
+// safe from several threads: only the thread that claims the empty cache
+// fills it, and the others meanwhile use the statistics they computed.
+class EnsembleStatsCache {
+ public:
+  EnsembleStatsCache() = default;
+
+  EnsembleStatsCache(const EnsembleStatsCache &other) noexcept { *this = other; }
+
+  EnsembleStatsCache &operator=(const EnsembleStatsCache &other) noexcept {
+    if (other.state.load(std::memory_order_acquire) == kValid) {
+      stats = other.stats;
+      state.store(kValid, std::memory_order_release);
+    } else
+      state.store(kEmpty, std::memory_order_relaxed);
+    return *this;
+  }
+
+  // the samples of a moved-from ensemble are no longer those of the cache
+  EnsembleStatsCache(EnsembleStatsCache &&other) noexcept : EnsembleStatsCache(other) {
+    other.invalidate();
+  }
+
+  EnsembleStatsCache &operator=(EnsembleStatsCache &&other) noexcept {
+    *this = other;
+    other.invalidate();
+    return *this;
+  }
+
+  void invalidate() { state.store(kEmpty, std::memory_order_relaxed); }
+
+  bool valid() const { return state.load(std::memory_order_acquire) == kValid; }
+
+  // the cached statistics, or those returned by compute() if there are none
+  template <class Compute>
+  EnsembleStats get(Compute compute) const {
+    if (state.load(std::memory_order_acquire) == kValid) return stats;
+    EnsembleStats retval = compute();
+    uint8_t expected = kEmpty;
+    if (state.compare_exchange_strong(expected, kFilling, std::memory_order_acquire)) {
+      stats = retval;
+      state.store(kValid, std::memory_order_release);
+    }
+    return retval;
+  }
+
+ private:
+  enum : uint8_t { kEmpty, kFilling, kValid };
+  mutable EnsembleStats stats;
+  mutable std::atomic<uint8_t> state{kEmpty};
+};
+
+// How the samples of a source of uncertainty were made: from the seed and
+// the source number they can be made again, so the table of sources needs
+// a few dozen bytes per source instead of a copy of its samples.
+struct EnsembleSourceRecipe {
+  enum Kind : uint8_t {
+    none,          // not recorded (yet)
+    gaussian,      // offset + scale * standard normal
+    distribution,  // offset + scale * the standard distribution of shape
+    samples        // given samples, kept in src_ensemble
+  };
+
+  Kind kind = none;
+  EnsembleSampling sampling = EnsembleSampling::shuffled_basis;
+  DistributionShape shape{DistributionShape::uniform};
+  double offset = 0.0;
+  double scale = 0.0;
+  uint64_t seed = 0;
+};
+
+// Makes the n samples of source number source_num by its recipe, which
+// depend only on the recipe and the source number, into x.  gauss is the
+// Gaussian basis of n samples, needed for the gaussian recipes that are
+// shuffled; the bases of the other shapes are shared by quantile_basis().
+void make_recipe_samples(const EnsembleSourceRecipe &recipe, size_t source_num, size_t n,
+                         const double *gauss, double *x);
+
+// The share of the variance of the n samples x, of the given mean, due to
+// each of num_sources sources whose samples are written by
+// source_samples(source_num, samples), which returns false for sources
+// not tracked.  The samples are centered once; the sources are made again
+// and projected on them a block at a time, on several threads.
+EnsembleAttribution attribute_samples(const double *x, size_t n, double mean, size_t num_sources,
+                                      const std::function<bool(size_t, double *)> &source_samples,
+                                      const SourceSet &sources);
+
+// Ensembles too short to fill two chunks of this many samples are never
+// split across threads.
+constexpr size_t kEnsembleMinChunk = 8192;
+
+// The parallel threshold of the ensemble classes when none is set: their
+// loops stay on the calling thread whatever the size.
+constexpr size_t kEnsembleSerial = SIZE_MAX;
+
+// kernel(a, ...) over the n samples of a, split across the threads of
+// parallel_for() when n is at least threshold, else in a single call.
+void ensemble_apply(void (*kernel)(double *, size_t), double *a, size_t n, size_t threshold);
+void ensemble_apply(void (*kernel)(double *, const double *, size_t), double *a, const double *b,
+                    size_t n, size_t threshold);
+void ensemble_apply(void (*kernel)(double *, double, size_t), double *a, double b, size_t n,
+                    size_t threshold);
+
+// The moment sums of the n samples x.  From threshold samples up they are
+// summed a block at a time on several threads and the blocks merged in
+// order, so the result does not depend on the number of threads.
+MomentSums ensemble_moment_sums(const double *x, size_t n, size_t threshold);
+
+// the statistics of the samples from their moment sums
+EnsembleStats ensemble_stats(const MomentSums &sums);
+
+// The size-independent parts of the ensemble classes, on n samples at x
+// (and b), so the fixed-size and dynamic classes share them.
+
+// co-moments of a[i] with b[(i + offset) % n], in a single pass made of
+// the two runs of pairs that do not wrap around
+CoMomentSums ensemble_comoment_sums(const double *a, const double *b, size_t n, size_t offset);
+
+// the correlation of a[i] with b[(i + offset) % n], 0 if either is constant
+double ensemble_correlation(const double *a, const double *b, size_t n, size_t offset);
+
+// the covariance of a[i] with b[(i + offset) % n], over n as the deviation
+double ensemble_covariance(const double *a, const double *b, size_t n, size_t offset);
+
+// the samples counted in bins between low and high
+Histogram ensemble_histogram(const double *x, size_t n, double low, double high, size_t bins);
+
+// the quantiles of the samples for several probabilities, with one copy
+// of the samples and a partial sort for each
+std::vector<double> ensemble_quantiles(const double *x, size_t n,
+                                       const std::vector<double> &probabilities);
+
+// the central interval holding the given probability of the samples
+std::pair<double, double> ensemble_credible_interval(const double *x, size_t n,
+                                                     double probability);
+
+// the mean and deviation, then the skew, kurtosis and m5 if there is any
+// uncertainty, as operator<< writes them
+void print_ensemble_stats(const EnsembleStats &stats, std::ostream &os);
+
+// the share of the variance due to each source from attribute(), which is
+// not called if the deviation is 0
+void print_ensemble_sources(double deviation, const std::function<EnsembleAttribution()> &attribute,
+                            std::ostream &os);
+
+// a text histogram of the samples in bins of half a deviation, with the
+// outliers beyond 4 deviations in the outer bins
+void print_ensemble_histogram(const double *x, size_t n, const EnsembleStats &stats,
+                              std::ostream &os);
+
 // Ensemble uncertainty class.  Represents a distribution by a
 // set of n=ensemble_size possible values distributed at intervals of
 // uniform probability throughout the distribution.  The order of the
@@ -61,21 +251,133 @@ namespace uncertain {
 // class can be anywhere from very expensive computationally to unusably
 // expensive. But for small problems and big ensemble_sizes it gives
 // "perfect" answers.
-template <size_t ensemble_size>
+//
+// The samples are kept in a Storage policy from ensemble_storage.hpp.
+// Each Storage makes a distinct class with its own static source set.
+template <size_t ensemble_size, class Storage = DefaultEnsembleStorage<ensemble_size>>
 class UDoubleEnsemble {
  public:
+  // the samples of the sources made from given samples; source_samples()
+  // gives those of every source
   static std::vector<std::vector<double>> src_ensemble;
   static SourceSet sources;
   static std::vector<double> gauss_ensemble;
 
  private:
   size_t epoch;
-  std::vector<double> ensemble;
+  Storage ensemble;
+  EnsembleStatsCache stats_cache;
 
   //  static SourceSet sources;
 
-  typedef double (*fun1type)(double);
-  typedef double (*fun2type)(double, double);
+  // guards src_ensemble and the recipes, which values made on any thread
+  // add to
+  static std::mutex &tables_mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  // the recipes of the sources of this epoch, by source number
+  static std::vector<EnsembleSourceRecipe> &recipes() {
+    static std::vector<EnsembleSourceRecipe> recipes;
+    return recipes;
+  }
+
+  static std::atomic<bool> &tracking_value() {
+    static std::atomic<bool> tracking{true};
+    return tracking;
+  }
+
+  static std::atomic<uint64_t> &seed_value() {
+    static std::atomic<uint64_t> seed{0};
+    return seed;
+  }
+
+  static std::atomic<size_t> &parallel_threshold_value() {
+    static std::atomic<size_t> threshold{kEnsembleSerial};
+    return threshold;
+  }
+
+  static std::atomic<EnsembleSampling> &sampling_value() {
+    static std::atomic<EnsembleSampling> sampling{EnsembleSampling::shuffled_basis};
+    return sampling;
+  }
+
+  // The base ensemble of n=ensemble_size points needs be initialized only
+  // once for each ensemble size.  Once it is initialized, each new
+  // independent uncertainty element can be made by copying & shuffling
+  // this array then scaling it to the appropriate uncertainty and
+  // translating it to the appropriate mean.  The initialization runs
+  // exactly once, even when the first values are made on several threads,
+  // and takes the basis from the tables built with the library or the
+  // on-disk cache where it can (see ensemble_basis.hpp).
+  static const std::vector<double> &gauss_basis() {
+    static const bool initialized = [] {
+      if (gauss_ensemble.size() != ensemble_size) gauss_ensemble = make_gauss_basis(ensemble_size);
+      return true;
+    }();
+    (void)initialized;
+    return gauss_ensemble;
+  }
+
+  // writes the samples of source number source_num, made by its recipe, to x
+  static void make_samples(const EnsembleSourceRecipe &recipe, size_t source_num, double *x) {
+    const double *gauss =
+        recipe.kind == EnsembleSourceRecipe::gaussian ? gauss_basis().data() : nullptr;
+    make_recipe_samples(recipe, source_num, ensemble_size, gauss, x);
+  }
+
+  // starts a new source by the recipe, which depends only on the seed and
+  // the source number, and keeps the recipe for the correlations with it
+  void make_source(EnsembleSourceRecipe recipe, size_t source_num) {
+    recipe.sampling = get_sampling();
+    recipe.seed = get_seed();
+    make_samples(recipe, source_num, samples());
+    record_source(source_num, recipe);
+  }
+
+  static void record_source(size_t source_num, const EnsembleSourceRecipe &recipe) {
+    if (!get_source_tracking()) return;
+    std::lock_guard<std::mutex> lock(tables_mutex());
+    std::vector<EnsembleSourceRecipe> &table = recipes();
+    if (source_num >= table.size()) table.resize(source_num + 1);
+    table[source_num] = recipe;
+  }
+
+  // the samples for writing; the cached statistics no longer apply
+  double *samples() {
+    stats_cache.invalidate();
+    return ensemble.data();
+  }
+
+  // kernel over the samples a (and b), split across threads from the
+  // parallel threshold up
+  static void apply(void (*kernel)(double *, size_t), double *a) {
+    ensemble_apply(kernel, a, ensemble_size, get_parallel_threshold());
+  }
+
+  static void apply(void (*kernel)(double *, const double *, size_t), double *a,
+                    const double *b) {
+    ensemble_apply(kernel, a, b, ensemble_size, get_parallel_threshold());
+  }
+
+  static void apply(void (*kernel)(double *, double, size_t), double *a, double b) {
+    ensemble_apply(kernel, a, b, ensemble_size, get_parallel_threshold());
+  }
+
+  // body(begin, end) over the samples, likewise
+  template <class Body>
+  static void for_samples(const Body &body) {
+    if (ensemble_size < get_parallel_threshold())
+      body(size_t(0), ensemble_size);
+    else
+      parallel_for(ensemble_size, kEnsembleMinChunk, body);
+  }
+
+  static void check_epochs(const UDoubleEnsemble &a, const UDoubleEnsemble &b) {
+    sources.check_epoch(a.epoch);
+    sources.check_epoch(b.epoch);
+  }
 
  public:
   // The main constructor initializes a new source of uncertainty
@@ -86,40 +388,7 @@ class UDoubleEnsemble {
       throw std::runtime_error("Error: negative uncertainty: " + std::to_string(unc));
     }
 
-    ensemble.resize(ensemble_size);
-
     if (unc != 0.0) {
-      // The base ensemble of n=ensemble_size points needs be initialized only
-      // once for each ensemble size.  Once it is initialized, each new
-      // independent uncertainty element can be made by copying & shuffling
-      // this array then scaling it to the appropriate uncertainty and
-      // translating it to the appropriate mean.
-      if (gauss_ensemble.size() != ensemble_size) {
-        gauss_ensemble.resize(ensemble_size);
-        if (ensemble_size & 1)  // odd ensemble size
-        {
-          for (size_t i = 0; i < ensemble_size / 2; i++) {
-            double deviate = inverse_gaussian_density((2.0 * (i + 1.0)) / (2.0 * ensemble_size));
-            gauss_ensemble[2 * i] = deviate;
-            gauss_ensemble[2 * i + 1] = -deviate;
-          }
-          gauss_ensemble[ensemble_size - 1] = 0.0;
-        } else {
-          for (size_t i = 0; i < ensemble_size / 2; i++) {
-            double deviate = 0.0;
-            double k = (2.0 * i + 1.0) / (2.0 * ensemble_size);
-            for (unsigned j = 0; j < 100; j++)
-              deviate += inverse_gaussian_density(k + (j - 49.5) / (100.0 * ensemble_size));
-            deviate /= 100.0;
-            gauss_ensemble[2 * i] = deviate;
-            gauss_ensemble[2 * i + 1] = -deviate;
-          }
-        }
-        // Move the points a little to make all the first 5 moments give
-        // exact values.
-        PerfectEnsemble(gauss_ensemble);
-      }
-      for (size_t i = 0; i < ensemble_size; i++) ensemble[i] = val + gauss_ensemble[i] * unc;
       std::string source_name;
       if (!name.empty()) {
         source_name = name;
@@ -129,565 +398,620 @@ class UDoubleEnsemble {
         uncertain_print(val, unc, os);
         source_name = os.str();
       }
-      this->shuffle();
-      auto source_num = sources.get_new_source(source_name);
-      if (source_num >= src_ensemble.size()) src_ensemble.resize(source_num + 1);
-      src_ensemble[source_num] = ensemble;
+      auto source_num = sources.get_new_source(source_name, epoch);
+      EnsembleSourceRecipe recipe;
+      recipe.kind = EnsembleSourceRecipe::gaussian;
+      recipe.offset = val;
+      recipe.scale = unc;
+      make_source(recipe, source_num);
     } else  // uncertainty is zero
       for (size_t i = 0; i < ensemble_size; i++) ensemble[i] = val;
   }
 
   // copy constructor does not introduce a new uncertainty element
-  UDoubleEnsemble(const UDoubleEnsemble &ud) {
-    epoch = ud.epoch;
-    ensemble = ud.ensemble;
-  }
+  UDoubleEnsemble(const UDoubleEnsemble &ud) = default;
+
+  // a moved-from ensemble keeps storage of its own, holding unspecified
+  // samples until it is assigned
+  UDoubleEnsemble(UDoubleEnsemble &&ud) = default;
+
+  UDoubleEnsemble &operator=(const UDoubleEnsemble &ud) = default;
 
-  // constructor from an ensemble.
+  UDoubleEnsemble &operator=(UDoubleEnsemble &&ud) noexcept = default;
+
+  // constructor from an ensemble.  Pass an rvalue to hand the vector over
+  // to the table of sources instead of copying it.
   // \todo add similar function that shuffles its input
-  UDoubleEnsemble(const std::vector<double> &newensemble, const std::string &name = {})
+  UDoubleEnsemble(std::vector<double> newensemble, const std::string &name = {})
       : epoch(sources.get_epoch()) {
     if (newensemble.size() != ensemble_size) {
       throw std::runtime_error("Cannot construct from wrong ensemble size");
     }
-    ensemble = newensemble;
+    std::copy(newensemble.begin(), newensemble.end(), ensemble.begin());
     std::string source_name;
     if (!name.empty()) {
       source_name = name;
     } else {
       source_name = "anon from ensemble: " + std::to_string(ensemble[0]);
     }
-    size_t source_num = sources.get_new_source(source_name);
+    size_t source_num = sources.get_new_source(source_name, epoch);
+    if (!get_source_tracking()) return;
+    // samples from elsewhere cannot be made again, so they are kept whole
+    std::lock_guard<std::mutex> lock(tables_mutex());
     if (source_num >= src_ensemble.size()) src_ensemble.resize(source_num + 1);
-    src_ensemble[source_num] = ensemble;
+    src_ensemble[source_num] = std::move(newensemble);
+    if (source_num >= recipes().size()) recipes().resize(source_num + 1);
+    recipes()[source_num].kind = EnsembleSourceRecipe::samples;
   }
 
-  // \todo add constructors with other distributions.
+  // constructor from a distribution of distributions.hpp, e.g.
+  // UDoubleEnsemble(Uniform(0.0, 1.0)), a new source of uncertainty.  The
+  // standard samples of each shape are made once and shared, so each new
+  // value costs a copy, a scale and a shuffle.
+  template <class Distribution, class = decltype(std::declval<const Distribution &>().shape())>
+  explicit UDoubleEnsemble(const Distribution &dist, const std::string &name = {})
+      : epoch(sources.get_epoch()) {
+    auto source_num = sources.get_new_source(name.empty() ? dist.name() : name, epoch);
+    EnsembleSourceRecipe recipe;
+    recipe.kind = EnsembleSourceRecipe::distribution;
+    recipe.shape = dist.shape();
+    recipe.offset = dist.offset();
+    recipe.scale = dist.scale();
+    make_source(recipe, source_num);
+  }
 
   ~UDoubleEnsemble() = default;
 
-  double mean() const {
-    double sum{0.0};
-    for (const auto &e : ensemble) sum += e;
-    return sum / ensemble_size;
-  }
+  double mean() const { return stats().mean; }
 
-  double deviation() const {
-    double sum_2_diff{0.0};  // watch overflow!
-    double value = this->mean();
+  double deviation() const { return stats().deviation; }
 
-    for (const auto &e : ensemble) sum_2_diff += sqr(e - value);
-    return std::sqrt(sum_2_diff / ensemble_size);
+  // the mean, deviation and higher moments together, from a single pass
+  // over the samples the first time they are asked for after a change
+  EnsembleStats stats() const {
+    return stats_cache.get([this] {
+      return ensemble_stats(
+          ensemble_moment_sums(ensemble.data(), ensemble_size, get_parallel_threshold()));
+    });
   }
 
-  UDoubleEnsemble<ensemble_size> operator+() const { return *this; }
+  UDoubleEnsemble operator+() const & { return *this; }
+
+  UDoubleEnsemble operator+() && { return std::move(*this); }
 
-  UDoubleEnsemble<ensemble_size> operator-() const {
-    UDoubleEnsemble<ensemble_size> retval;
-    for (size_t i = 0; i < ensemble_size; i++) retval.ensemble[i] = -ensemble[i];
-    retval.epoch = epoch;
+  UDoubleEnsemble operator-() const & {
+    UDoubleEnsemble retval(*this);
+    apply(vec_negate, retval.samples());
     return retval;
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator+(UDoubleEnsemble<ensemble_size> a,
-                                                  const UDoubleEnsemble<ensemble_size> &b) {
-    return a += b;
+  UDoubleEnsemble operator-() && {
+    apply(vec_negate, samples());
+    return std::move(*this);
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator+(UDoubleEnsemble<ensemble_size> a, double b) {
-    return a += b;
+  // The binary operators take their left operand by value, so a temporary
+  // on the left is moved in and its samples are updated in place.  The
+  // overloads taking an rvalue right operand do the same with the right
+  // operand's samples, so chained expressions allocate no new storage.
+  friend UDoubleEnsemble operator+(UDoubleEnsemble a, const UDoubleEnsemble &b) {
+    a += b;
+    return a;
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator+(double b, UDoubleEnsemble<ensemble_size> a) {
-    return a += b;
+  friend UDoubleEnsemble operator+(const UDoubleEnsemble &a, UDoubleEnsemble &&b) {
+    b += a;
+    return std::move(b);
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator-(UDoubleEnsemble<ensemble_size> a,
-                                                  const UDoubleEnsemble<ensemble_size> &b) {
-    return a -= b;
+  friend UDoubleEnsemble operator+(UDoubleEnsemble a, double b) {
+    a += b;
+    return a;
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator-(UDoubleEnsemble<ensemble_size> a, double b) {
-    return a -= b;
+  friend UDoubleEnsemble operator+(double b, UDoubleEnsemble a) {
+    a += b;
+    return a;
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator-(double b, UDoubleEnsemble<ensemble_size> a) {
-    return -(a -= b);
+  friend UDoubleEnsemble operator-(UDoubleEnsemble a, const UDoubleEnsemble &b) {
+    a -= b;
+    return a;
   }
 
-  UDoubleEnsemble<ensemble_size> operator++() { return (*this += 1.0); }
+  friend UDoubleEnsemble operator-(const UDoubleEnsemble &a, UDoubleEnsemble &&b) {
+    check_epochs(a, b);
+    apply(vec_rsub, b.samples(), a.ensemble.data());
+    return std::move(b);
+  }
+
+  friend UDoubleEnsemble operator-(UDoubleEnsemble a, double b) {
+    a -= b;
+    return a;
+  }
+
+  friend UDoubleEnsemble operator-(double b, UDoubleEnsemble a) {
+    apply(vec_rsub, a.samples(), b);
+    return a;
+  }
 
-  UDoubleEnsemble<ensemble_size> operator--() { return (*this -= 1.0); }
+  UDoubleEnsemble &operator++() { return (*this += 1.0); }
 
-  UDoubleEnsemble<ensemble_size> operator++(int) {
-    UDoubleEnsemble<ensemble_size> retval(*this);
+  UDoubleEnsemble &operator--() { return (*this -= 1.0); }
+
+  UDoubleEnsemble operator++(int) {
+    UDoubleEnsemble retval(*this);
     *this += 1.0;
     return retval;
   }
 
-  UDoubleEnsemble<ensemble_size> operator--(int) {
-    UDoubleEnsemble<ensemble_size> retval(*this);
+  UDoubleEnsemble operator--(int) {
+    UDoubleEnsemble retval(*this);
     *this -= 1.0;
     return retval;
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator*(UDoubleEnsemble<ensemble_size> a,
-                                                  const UDoubleEnsemble<ensemble_size> &b) {
-    return a *= b;
+  friend UDoubleEnsemble operator*(UDoubleEnsemble a, const UDoubleEnsemble &b) {
+    a *= b;
+    return a;
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator*(UDoubleEnsemble<ensemble_size> a, double b) {
-    return a *= b;
+  friend UDoubleEnsemble operator*(const UDoubleEnsemble &a, UDoubleEnsemble &&b) {
+    b *= a;
+    return std::move(b);
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator*(double b, UDoubleEnsemble<ensemble_size> a) {
-    return a *= b;
+  friend UDoubleEnsemble operator*(UDoubleEnsemble a, double b) {
+    a *= b;
+    return a;
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator/(UDoubleEnsemble<ensemble_size> a,
-                                                  const UDoubleEnsemble<ensemble_size> &b) {
-    return a /= b;
+  friend UDoubleEnsemble operator*(double b, UDoubleEnsemble a) {
+    a *= b;
+    return a;
   }
 
-  friend UDoubleEnsemble<ensemble_size> operator/(UDoubleEnsemble<ensemble_size> a, double b) {
-    return a /= b;
+  friend UDoubleEnsemble operator/(UDoubleEnsemble a, const UDoubleEnsemble &b) {
+    a /= b;
+    return a;
   }
 
-  // this one promotes a to UDoubleEnsemble
-  friend UDoubleEnsemble<ensemble_size> operator/(double a,
-                                                  const UDoubleEnsemble<ensemble_size> &b) {
-    UDoubleEnsemble<ensemble_size> uda(a);
-    return uda /= b;
+  friend UDoubleEnsemble operator/(const UDoubleEnsemble &a, UDoubleEnsemble &&b) {
+    check_epochs(a, b);
+    apply(vec_rdiv, b.samples(), a.ensemble.data());
+    return std::move(b);
   }
 
-  UDoubleEnsemble<ensemble_size> &operator+=(const UDoubleEnsemble<ensemble_size> &ud) {
-    sources.check_epoch(epoch);
-    sources.check_epoch(ud.epoch);
+  friend UDoubleEnsemble operator/(UDoubleEnsemble a, double b) {
+    a /= b;
+    return a;
+  }
 
-    for (size_t i = 0; i < ensemble_size; i++) ensemble[i] += ud.ensemble[i];
-    return *this;
+  friend UDoubleEnsemble operator/(double a, UDoubleEnsemble b) {
+    apply(vec_rdiv, b.samples(), a);
+    return b;
   }
 
-  UDoubleEnsemble<ensemble_size> &operator+=(double d) {
-    for (size_t i = 0; i < ensemble_size; i++) ensemble[i] += d;
+  UDoubleEnsemble &operator+=(const UDoubleEnsemble &ud) {
+    check_epochs(*this, ud);
+    apply(vec_add, samples(), ud.ensemble.data());
     return *this;
   }
 
-  UDoubleEnsemble<ensemble_size> &operator-=(const UDoubleEnsemble<ensemble_size> &ud) {
-    sources.check_epoch(epoch);
-    sources.check_epoch(ud.epoch);
-
-    for (size_t i = 0; i < ensemble_size; i++) ensemble[i] -= ud.ensemble[i];
+  UDoubleEnsemble &operator+=(double d) {
+    apply(vec_add, samples(), d);
     return *this;
   }
 
-  UDoubleEnsemble<ensemble_size> &operator-=(double d) {
-    for (size_t i = 0; i < ensemble_size; i++) ensemble[i] -= d;
+  UDoubleEnsemble &operator-=(const UDoubleEnsemble &ud) {
+    check_epochs(*this, ud);
+    apply(vec_sub, samples(), ud.ensemble.data());
     return *this;
   }
 
-  UDoubleEnsemble<ensemble_size> &operator*=(const UDoubleEnsemble<ensemble_size> &ud) {
-    sources.check_epoch(epoch);
-    sources.check_epoch(ud.epoch);
-
-    for (size_t i = 0; i < ensemble_size; i++) ensemble[i] *= ud.ensemble[i];
+  UDoubleEnsemble &operator-=(double d) {
+    apply(vec_sub, samples(), d);
     return *this;
   }
 
-  UDoubleEnsemble<ensemble_size> &operator*=(double d) {
-    for (size_t i = 0; i < ensemble_size; i++) ensemble[i] *= d;
+  UDoubleEnsemble &operator*=(const UDoubleEnsemble &ud) {
+    check_epochs(*this, ud);
+    apply(vec_mul, samples(), ud.ensemble.data());
     return *this;
   }
 
-  UDoubleEnsemble<ensemble_size> &operator/=(const UDoubleEnsemble<ensemble_size> &ud) {
-    sources.check_epoch(epoch);
-    sources.check_epoch(ud.epoch);
+  UDoubleEnsemble &operator*=(double d) {
+    apply(vec_mul, samples(), d);
+    return *this;
+  }
 
-    for (size_t i = 0; i < ensemble_size; i++) ensemble[i] /= ud.ensemble[i];
+  UDoubleEnsemble &operator/=(const UDoubleEnsemble &ud) {
+    check_epochs(*this, ud);
+    apply(vec_div, samples(), ud.ensemble.data());
     return *this;
   }
 
-  UDoubleEnsemble<ensemble_size> &operator/=(double d) {
-    for (size_t i = 0; i < ensemble_size; i++) ensemble[i] /= d;
+  UDoubleEnsemble &operator/=(double d) {
+    apply(vec_div, samples(), d);
     return *this;
   }
 
   // \todo add procedures to make persistent
-  friend std::ostream &operator<<(std::ostream &os, const UDoubleEnsemble<ensemble_size> &ud) {
-    double mean, sigma, skew, kurtosis, m5;
-    moments(ud.ensemble, mean, sigma, skew, kurtosis, m5);
-    uncertain_print(mean, sigma, os);
-
-    if (sigma != 0.0) {
-      auto original_precision = os.precision();
-      auto original_format = os.flags(std::ios::showpoint);
-      os << std::setprecision(2) << " [" << skew << " : " << kurtosis << " : " << m5 << "]"
-         << std::setprecision(original_precision);
-      os.flags(original_format);
-    }
+  friend std::ostream &operator<<(std::ostream &os, const UDoubleEnsemble &ud) {
+    print_ensemble_stats(ud.stats(), os);
     return os;
   }
 
-  friend std::istream &operator>>(std::istream &is, UDoubleEnsemble<ensemble_size> &ud) {
+  friend std::istream &operator>>(std::istream &is, UDoubleEnsemble &ud) {
     double mean, sigma;
     uncertain_read(mean, sigma, is);
-    ud = UDoubleEnsemble<ensemble_size>(mean, sigma);
+    ud = UDoubleEnsemble(mean, sigma);
     return is;
   }
 
-  static UDoubleEnsemble<ensemble_size> func1(std::function<double(double)> func,
-                                              UDoubleEnsemble<ensemble_size> arg) {
-    for (size_t i = 0; i < ensemble_size; i++) arg.ensemble[i] = func(arg.ensemble[i]);
+  // Applies func to every sample.  func may be any callable, e.g. sin_tag{}
+  // or a lambda; it is a template parameter so the call is inlined.  From
+  // the parallel threshold up it is called on several threads at once.
+  template <class Func>
+  static UDoubleEnsemble func1(Func func, UDoubleEnsemble arg) {
+    double *x = arg.samples();
+    for_samples([&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) x[i] = func(x[i]);
+    });
     return arg;
   }
 
-  static UDoubleEnsemble<ensemble_size> func2(std::function<double(double, double)> func,
-                                              const UDoubleEnsemble<ensemble_size> &arg1,
-                                              const UDoubleEnsemble<ensemble_size> &arg2) {
-    UDoubleEnsemble<ensemble_size> retval(arg1);
-    for (size_t i = 0; i < ensemble_size; i++)
-      retval.ensemble[i] = func(arg1.ensemble[i], arg2.ensemble[i]);
+  template <class Func>
+  static UDoubleEnsemble func2(Func func, const UDoubleEnsemble &arg1,
+                               const UDoubleEnsemble &arg2) {
+    check_epochs(arg1, arg2);
+    UDoubleEnsemble retval(arg1);
+    double *x = retval.samples();
+    for_samples([&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) x[i] = func(arg1.ensemble[i], arg2.ensemble[i]);
+    });
     return retval;
   }
 
-  friend UDoubleEnsemble<ensemble_size> sqrt(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::sqrt), arg);
+  friend UDoubleEnsemble sqrt(UDoubleEnsemble arg) {
+    apply(vec_sqrt, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> sin(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::sin), arg);
+  friend UDoubleEnsemble sin(UDoubleEnsemble arg) {
+    apply(vec_sin, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> cos(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::cos), arg);
+  friend UDoubleEnsemble cos(UDoubleEnsemble arg) {
+    apply(vec_cos, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> tan(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::tan), arg);
+  friend UDoubleEnsemble tan(UDoubleEnsemble arg) {
+    apply(vec_tan, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> asin(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::asin), arg);
+  friend UDoubleEnsemble asin(UDoubleEnsemble arg) {
+    apply(vec_asin, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> acos(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::acos), arg);
+  friend UDoubleEnsemble acos(UDoubleEnsemble arg) {
+    apply(vec_acos, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> atan(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::atan), arg);
+  friend UDoubleEnsemble atan(UDoubleEnsemble arg) {
+    apply(vec_atan, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> ceil(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::ceil), arg);
+  friend UDoubleEnsemble ceil(UDoubleEnsemble arg) {
+    apply(vec_ceil, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> floor(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::floor), arg);
+  friend UDoubleEnsemble floor(UDoubleEnsemble arg) {
+    apply(vec_floor, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> fabs(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::fabs), arg);
+  friend UDoubleEnsemble fabs(UDoubleEnsemble arg) {
+    apply(vec_fabs, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> exp(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::exp), arg);
+  friend UDoubleEnsemble exp(UDoubleEnsemble arg) {
+    apply(vec_exp, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> log(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::log), arg);
+  friend UDoubleEnsemble log(UDoubleEnsemble arg) {
+    apply(vec_log, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> log10(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::log10), arg);
+  friend UDoubleEnsemble log10(UDoubleEnsemble arg) {
+    apply(vec_log10, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> sinh(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::sinh), arg);
+  friend UDoubleEnsemble sinh(UDoubleEnsemble arg) {
+    apply(vec_sinh, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> cosh(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::cosh), arg);
+  friend UDoubleEnsemble cosh(UDoubleEnsemble arg) {
+    apply(vec_cosh, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> tanh(UDoubleEnsemble<ensemble_size> arg) {
-    return func1(static_cast<fun1type>(&std::tanh), arg);
+  friend UDoubleEnsemble tanh(UDoubleEnsemble arg) {
+    apply(vec_tanh, arg.samples());
+    return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> fmod(const UDoubleEnsemble<ensemble_size> &arg1,
-                                             const UDoubleEnsemble<ensemble_size> &arg2) {
-    return func2(static_cast<fun2type>(&std::fmod), arg1, arg2);
+  friend UDoubleEnsemble fmod(const UDoubleEnsemble &arg1, const UDoubleEnsemble &arg2) {
+    check_epochs(arg1, arg2);
+    UDoubleEnsemble retval(arg1);
+    apply(vec_fmod, retval.samples(), arg2.ensemble.data());
+    return retval;
   }
 
-  friend UDoubleEnsemble<ensemble_size> atan2(const UDoubleEnsemble<ensemble_size> &arg1,
-                                              const UDoubleEnsemble<ensemble_size> &arg2) {
-    return func2(static_cast<fun2type>(&std::atan2), arg1, arg2);
+  friend UDoubleEnsemble atan2(const UDoubleEnsemble &arg1, const UDoubleEnsemble &arg2) {
+    check_epochs(arg1, arg2);
+    UDoubleEnsemble retval(arg1);
+    apply(vec_atan2, retval.samples(), arg2.ensemble.data());
+    return retval;
   }
 
-  friend UDoubleEnsemble<ensemble_size> pow(const UDoubleEnsemble<ensemble_size> &arg1,
-                                            const UDoubleEnsemble<ensemble_size> &arg2) {
-    return func2(static_cast<fun2type>(&std::pow), arg1, arg2);
+  friend UDoubleEnsemble pow(const UDoubleEnsemble &arg1, const UDoubleEnsemble &arg2) {
+    check_epochs(arg1, arg2);
+    UDoubleEnsemble retval(arg1);
+    apply(vec_pow, retval.samples(), arg2.ensemble.data());
+    return retval;
   }
 
-  friend UDoubleEnsemble<ensemble_size> ldexp(UDoubleEnsemble<ensemble_size> arg,
-                                              const int intarg) {
-    for (size_t i = 0; i < ensemble_size; i++)
-      arg.ensemble[i] = std::ldexp(arg.ensemble[i], intarg);
+  friend UDoubleEnsemble ldexp(UDoubleEnsemble arg, const int intarg) {
+    double *x = arg.samples();
+    for_samples([=](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) x[i] = std::ldexp(x[i], intarg);
+    });
     return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> frexp(UDoubleEnsemble<ensemble_size> arg, int *intarg) {
+  friend UDoubleEnsemble frexp(UDoubleEnsemble arg, int *intarg) {
     // use library frexp on mean to get value of return in second arg
     std::frexp(arg.mean(), intarg);
-    for (size_t i = 0; i < ensemble_size; i++) {
-      int tempint;  // ignore return in second arg in loop
-      arg.ensemble[i] = std::frexp(arg.ensemble[i], &tempint);
-    }
+    double *x = arg.samples();
+    for_samples([=](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        int tempint;  // ignore return in second arg in loop
+        x[i] = std::frexp(x[i], &tempint);
+      }
+    });
     return arg;
   }
 
-  friend UDoubleEnsemble<ensemble_size> modf(UDoubleEnsemble<ensemble_size> arg, double *dblarg) {
+  friend UDoubleEnsemble modf(UDoubleEnsemble arg, double *dblarg) {
     // use library modf on mean to get value of return in second arg
     std::modf(arg.mean(), dblarg);
-    for (size_t i = 0; i < ensemble_size; i++) {
-      double tempdbl;  // ignore return in second arg in loop
-      arg.ensemble[i] = std::modf(arg.ensemble[i], &tempdbl);
-    }
+    double *x = arg.samples();
+    for_samples([=](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        double tempdbl;  // ignore return in second arg in loop
+        x[i] = std::modf(x[i], &tempdbl);
+      }
+    });
     return arg;
   }
 
+  // The seed for shuffling new values.  Source number k of any epoch is
+  // shuffled by stream k of the seed, whichever thread makes it, so the
+  // same program gives the same ensembles in every run.
+  static void set_seed(uint64_t seed) { seed_value().store(seed, std::memory_order_relaxed); }
+
+  static uint64_t get_seed() { return seed_value().load(std::memory_order_relaxed); }
+
+  // How new values are sampled; see sampling.hpp.  The shuffled basis
+  // gives exact moments for each source, the others pair the sources of
+  // uncertainty more evenly with each other.
+  static void set_sampling(EnsembleSampling sampling) {
+    sampling_value().store(sampling, std::memory_order_relaxed);
+  }
+
+  static EnsembleSampling get_sampling() {
+    return sampling_value().load(std::memory_order_relaxed);
+  }
+
+  // Ensembles of at least this many samples split the loops of the
+  // operators, math functions, func1(), func2(), Invoke() and the moments
+  // across the threads of parallel_for().  kEnsembleSerial, the default,
+  // keeps them on the calling thread; around 65536 samples the threads
+  // start to pay off.
+  static void set_parallel_threshold(size_t threshold) {
+    parallel_threshold_value().store(threshold, std::memory_order_relaxed);
+  }
+
+  static size_t get_parallel_threshold() {
+    return parallel_threshold_value().load(std::memory_order_relaxed);
+  }
+
+  // Whether the sources of uncertainty are kept for print_uncertain_sources().
+  // Each takes a few dozen bytes, or a copy of the samples it was made from.
+  static void set_source_tracking(bool tracking) {
+    tracking_value().store(tracking, std::memory_order_relaxed);
+  }
+
+  static bool get_source_tracking() { return tracking_value().load(std::memory_order_relaxed); }
+
   static void new_epoch() {
+    std::lock_guard<std::mutex> lock(tables_mutex());
     sources.new_epoch();
     src_ensemble = {};
-    sources = SourceSet("???");
-  }
-
-  void print_uncertain_sources(std::ostream &os = std::cout) {
-    if (deviation() == 0.0)
-      os << "No uncertainty";
-    else {
-      double unaccounted_uncertainty = 1.0;
-      for (size_t i = 0; i < sources.get_num_sources(); i++) {
-        double unc_portion = this->correlation(src_ensemble[i]);
-        unc_portion *= unc_portion;
-        unaccounted_uncertainty -= unc_portion;
-        os << sources.get_source_name(i) << ": " << int_percent(unc_portion) << "%" << std::endl;
+    recipes() = {};
+  }
+
+  // the number of sources kept since the last new_epoch()
+  static size_t num_tracked_sources() {
+    std::lock_guard<std::mutex> lock(tables_mutex());
+    return recipes().size();
+  }
+
+  // Writes the n=ensemble_size samples of source number source_num, made
+  // again from its recipe, to x.  Returns false if the source is not
+  // tracked, or still being made on another thread.
+  static bool source_samples(size_t source_num, double *x) {
+    EnsembleSourceRecipe recipe;
+    {
+      std::lock_guard<std::mutex> lock(tables_mutex());
+      if (source_num < recipes().size()) recipe = recipes()[source_num];
+      if (recipe.kind == EnsembleSourceRecipe::samples) {
+        std::copy(src_ensemble[source_num].begin(), src_ensemble[source_num].end(), x);
+        return true;
       }
-      os << "other: " << int_percent(unaccounted_uncertainty) << "%" << std::endl;
-    }
-    os << std::endl;
-  }
-
-  double correlation(const UDoubleEnsemble<ensemble_size> &ud, const size_t offset = 0) const {
-    size_t i;
-    double diff, diff_ud;
-    double value = this->mean();
-    double ud_value = ud.mean();
-    // watch overflow!
-    double sum_2_diff = 0.0, sum_2_diff_ud = 0.0, sum_prod_diff = 0.0;
-
-    for (i = 0; i < ensemble_size; i++) {
-      diff = ensemble[i] - value;
-      sum_2_diff += diff * diff;
-      size_t j = (i + offset) % ensemble_size;
-      diff_ud = ud.ensemble[j] - ud_value;
-      sum_2_diff_ud += diff_ud * diff_ud;
-      sum_prod_diff += diff * diff_ud;
     }
-    if (!sum_2_diff) return 0.0;
-    if (!sum_2_diff_ud) return 0.0;
-    if (!sum_prod_diff) return 0.0;
-    return sum_prod_diff / std::sqrt(sum_2_diff * sum_2_diff_ud);
+    if (recipe.kind == EnsembleSourceRecipe::none) return false;
+    make_samples(recipe, source_num, x);
+    return true;
+  }
+
+  // The samples of source number source_num; empty if it is not tracked.
+  static std::vector<double> source_samples(size_t source_num) {
+    std::vector<double> retval(ensemble_size);
+    if (!source_samples(source_num, retval.data())) return {};
+    return retval;
+  }
+
+  // The share of the variance of this value due to each tracked source of
+  // uncertainty.
+  EnsembleAttribution attribute_sources() const {
+    return attribute_samples(ensemble.data(), ensemble_size, stats().mean, num_tracked_sources(),
+                             [](size_t i, double *x) { return source_samples(i, x); }, sources);
+  }
+
+  void print_uncertain_sources(std::ostream &os = std::cout) const {
+    print_ensemble_sources(deviation(), [this] { return attribute_sources(); }, os);
+  }
+
+  double correlation(const UDoubleEnsemble &ud, const size_t offset = 0) const {
+    check_epochs(*this, ud);
+    return ensemble_correlation(ensemble.data(), ud.ensemble.data(), ensemble_size, offset);
   }
 
   double correlation(const std::vector<double> &ens, const size_t offset = 0) const {
-    size_t i;
-    double diff, diff_ud;
-    double value = this->mean();
-    double ud_value = 0.0;
-    // watch overflow!
-    double sum_2_diff = 0, sum_2_diff_ud = 0, sum_prod_diff = 0;
-
-    for (i = 0; i < ens.size(); i++) ud_value += ens[i];
-    ud_value /= ens.size();
-    for (i = 0; i < ens.size(); i++) {
-      diff = ensemble[i] - value;
-      sum_2_diff += diff * diff;
-      size_t j = (i + offset) % ens.size();
-      diff_ud = ens[j] - ud_value;
-      sum_2_diff_ud += diff_ud * diff_ud;
-      sum_prod_diff += diff * diff_ud;
+    if (ens.size() != ensemble_size) {
+      throw std::runtime_error("Cannot correlate with wrong ensemble size");
+    }
+    return ensemble_correlation(ensemble.data(), ens.data(), ensemble_size, offset);
+  }
+
+  // the covariance of the samples, over the ensemble size as the deviation
+  double covariance(const UDoubleEnsemble &ud, const size_t offset = 0) const {
+    check_epochs(*this, ud);
+    return ensemble_covariance(ensemble.data(), ud.ensemble.data(), ensemble_size, offset);
+  }
+
+  // correlation(ud, offset) for every offset, in O(n log n) instead of
+  // O(n) for each
+  std::vector<double> lag_correlations(const UDoubleEnsemble &ud) const {
+    check_epochs(*this, ud);
+    return uncertain::lag_correlations(ensemble.data(), ud.ensemble.data(), ensemble_size);
+  }
+
+  std::vector<double> lag_correlations(const std::vector<double> &ens) const {
+    if (ens.size() != ensemble_size) {
+      throw std::runtime_error("Cannot correlate with wrong ensemble size");
     }
-    if (!sum_2_diff) return 0.0;
-    if (!sum_2_diff_ud) return 0.0;
-    if (!sum_prod_diff) return 0.0;
-    return sum_prod_diff / std::sqrt(sum_2_diff * sum_2_diff_ud);
+    return uncertain::lag_correlations(ensemble.data(), ens.data(), ensemble_size);
+  }
+
+  // The samples counted in bins between low and high.  Histograms of
+  // several ensembles over the same bins can be merged.
+  Histogram histogram(double low, double high, size_t bins) const {
+    return ensemble_histogram(ensemble.data(), ensemble_size, low, high, bins);
+  }
+
+  // the p quantile of the samples
+  double quantile(double p) const { return quantiles({p}).front(); }
+
+  // the quantiles of the samples for several probabilities
+  std::vector<double> quantiles(const std::vector<double> &probabilities) const {
+    return ensemble_quantiles(ensemble.data(), ensemble_size, probabilities);
+  }
+
+  // the central interval holding the given probability of the samples
+  std::pair<double, double> credible_interval(double probability = 0.95) const {
+    return ensemble_credible_interval(ensemble.data(), ensemble_size, probability);
   }
 
   // \todo add function that gives a description
-  // \todo allow superimposing histograms
   void print_histogram(std::ostream &os = std::cout) const {
-    // centered bins for each 0.5 sigmas from -4 sigmas to +4 sigmas
-    // outliers go in the outer bins
-    int bin[17] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    int i;
-    double value = this->mean();
-    double sigma = this->deviation();
-
-    if (sigma == 0.0) {
-      os << "No histogram when no uncertainty" << std::endl;
-      return;
-    }
-    for (i = 0; i < ensemble_size; i++) {
-      double normval = (ensemble[i] - value) / sigma;
-      int intval = int(std::floor(2.0 * normval + 0.5) + 8.0);
-      if (intval < 0)
-        bin[0]++;
-      else if (intval > 16)
-        bin[16]++;
-      else
-        bin[intval]++;
-    }
-    int binmax = 1;
-    for (i = 0; i < 17; i++)
-      if (bin[i] >= binmax) binmax = bin[i];
-    int scale_divisor = 1;
-    while (binmax / scale_divisor > 74) scale_divisor++;
-    os << "Histogram:  (each * represents ";
-    if (scale_divisor == 1)
-      os << "1 point)";
-    else
-      os << scale_divisor << " points)";
-    os << setiosflags(std::ios::showpos) << std::endl;
-    int bin_display[17];  // number of characters displayed in each bin
-    for (i = 0; i < 17; i++) {
-      bin_display[i] = int((bin[i] + 0.5) / scale_divisor);
-    }
-    size_t first_display_bin = 0, last_display_bin = 16;
-    while (bin_display[first_display_bin] == 0) first_display_bin++;
-    while (bin_display[last_display_bin] == 0) last_display_bin--;
-    for (i = first_display_bin; i <= last_display_bin; i++) {
-      if (i & 1)
-        os << "    | ";
-      else
-        os << std::setw(3) << (i / 2 - 4) << " + ";
-      for (int j = 0; j < bin_display[i]; j++) os << "*";
-      os << std::endl;
-    }
-    os << resetiosflags(std::ios::showpos) << std::endl;
+    print_ensemble_histogram(ensemble.data(), ensemble_size, stats(), os);
   }
 
-  friend UDoubleEnsemble<ensemble_size> Invoke(double (*certainfunc)(double),
-                                               const UDoubleEnsemble<ensemble_size> &arg) {
-    UDoubleEnsemble<ensemble_size> retval;
+  friend UDoubleEnsemble Invoke(double (*certainfunc)(double), const UDoubleEnsemble &arg) {
+    UDoubleEnsemble retval;
+    double *x = retval.samples();
+    const double *a = arg.ensemble.data();
+    for_samples([=](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) x[i] = certainfunc(a[i]);
+    });
+    return retval;
+  }
 
-    for (unsigned i = 0; i < ensemble_size; i++) retval.ensemble[i] = certainfunc(arg.ensemble[i]);
+  friend UDoubleEnsemble Invoke(double (*certainfunc)(double, double), const UDoubleEnsemble &arg1,
+                                const UDoubleEnsemble &arg2) {
+    UDoubleEnsemble retval;
+    double *x = retval.samples();
+    const double *a = arg1.ensemble.data(), *b = arg2.ensemble.data();
+    for_samples([=](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) x[i] = certainfunc(a[i], b[i]);
+    });
     return retval;
   }
 
-  friend UDoubleEnsemble<ensemble_size> Invoke(double (*certainfunc)(double, double),
-                                               const UDoubleEnsemble<ensemble_size> &arg1,
-                                               const UDoubleEnsemble<ensemble_size> &arg2) {
-    UDoubleEnsemble<ensemble_size> retval;
+  // shuffles the samples with the calling thread's generator
+  void shuffle() { shuffle(thread_engine()); }
 
-    for (unsigned i = 0; i < ensemble_size; i++)
-      retval.ensemble[i] = certainfunc(arg1.ensemble[i], arg2.ensemble[i]);
-    return retval;
+  // shuffles the samples with engine, e.g. a Xoshiro256
+  template <class Engine>
+  void shuffle(Engine &engine) {
+    shuffle_values(samples(), ensemble_size, engine);
   }
 
-  void shuffle() {
-    for (size_t i = 0; i < ensemble_size - 1; i++) {
-      size_t j = i + (size_t)rand() % (ensemble_size - i);
-      if (j != i) {
-        double temp = ensemble[i];
-        ensemble[i] = ensemble[j];
-        ensemble[j] = temp;
-      }
-    }
+  // the statistics of any container of samples, in a single pass
+  template <class Container>
+  static EnsembleStats stats(const Container &ens) {
+    return ensemble_stats(vec_moment_sums(ens.data(), ens.size()));
   }
 
   // figure the moments (sigma, skew, kurtosis, & 5th moment) from an
   // ensemble given the mean.
-  static void moments_fixed_mean(const std::vector<double> &ens, double mean, double &sigma,
-                                 double &skew, double &kurtosis, double &m5) {
-    size_t i;
-    double gddiff2 = 0.0, gddiff3 = 0.0, gddiff4 = 0.0, gddiff5 = 0.0;
-    std::vector<double> gddiff;
-    gddiff.resize(ens.size());
-
-    // Sorting ensemble by absolute value first increases accuracy
-    // but at a cost to performance.  Sorting is O(nlog(n)), whereas
-    // the rest of what's being done here is O(n) in ens_size.  Operationally
-    // this routine should be called mostly only when there is output,
-    // so the cost should be okay.
-    for (i = 0; i < ens.size(); i++) gddiff[i] = ens[i] - mean;
-    qsort(gddiff.data(), gddiff.size(), sizeof(double), abs_double_compare);
-    for (i = 0; i < ens.size(); i++) {
-      gddiff2 += gddiff[i] * gddiff[i];
-      gddiff3 += gddiff[i] * gddiff[i] * gddiff[i];
-      gddiff4 += gddiff[i] * gddiff[i] * gddiff[i] * gddiff[i];
-      gddiff5 += gddiff[i] * gddiff[i] * gddiff[i] * gddiff[i] * gddiff[i];
-    }
-    double var = gddiff2 / ens.size();
-    sigma = std::sqrt(var);
-    skew = gddiff3 / (var * sigma * ens.size());
-    kurtosis = gddiff4 / (var * var * ens.size()) - 3;
-    m5 = gddiff5 / (var * var * sigma * ens.size());
-    // std::cerr << mean << " +/- " << sigma << " [s: " << skew << ", k: ";
-    // std::cerr << kurtosis << " m5: " << m5 << "]" << std::endl;
+  // Compensated summation keeps these as accurate as summing the terms in
+  // order of increasing magnitude would, in a single O(n) pass.
+  template <class Container>
+  static void moments_fixed_mean(const Container &ens, double mean, double &sigma, double &skew,
+                                 double &kurtosis, double &m5) {
+    double sums[5];
+    vec_power_sums(ens.data(), ens.size(), mean, 5, sums);
+    moments_from_sums(ens.size(), sums, sigma, skew, kurtosis, m5);
   }
 
   // figure the moments (mean, sigma, skew, kurtosis, & 5th moment) from an
-  // ensemble
-  static void moments(const std::vector<double> &ens, double &mean, double &sigma, double &skew,
+  // ensemble.  This takes a second pass, for the mean first; stats() gives
+  // the same moments in one pass, to within a few roundings.
+  template <class Container>
+  static void moments(const Container &ens, double &mean, double &sigma, double &skew,
                       double &kurtosis, double &m5) {
-    size_t i;
-    double gdsum = 0.0;
-    std::vector<double> gddiff;
-    gddiff.resize(ens.size());
-
-    for (i = 0; i < ens.size(); i++) gdsum += ens[i];
-    mean = gdsum / ens.size();
-    // Sorting ensemble by absolute value first increases accuracy.
-    // See note in moments_fixed_mean().
-    for (i = 0; i < ens.size(); i++) gddiff[i] = ens[i] - mean;
-    qsort(gddiff.data(), gddiff.size(), sizeof(double), abs_double_compare);
-    gdsum = 0.0;
-    for (i = 0; i < ens.size(); i++) gdsum += gddiff[i];
-    mean += gdsum / ens.size();
-
-    moments_fixed_mean(ens, mean, sigma, skew, kurtosis, m5);
+    ensemble_moments(ens.data(), ens.size(), mean, sigma, skew, kurtosis, m5);
   }
 
   // This function moves points a little bit so the first 5 moments all
   // get measured at precisely the expected values.
-  static void PerfectEnsemble(std::vector<double> &ens) {
-    size_t i;
-    double value, sigma, skew, kurtosis, m5;
-
-    std::vector<double> test_ensemble;
-    test_ensemble.resize(ens.size());
-    for (int j = 0; j < 3; j++) {
-      moments(ens, value, sigma, skew, kurtosis, m5);
-
-      for (i = 0; i < ens.size(); i++) ens[i] -= value;
-      for (i = 0; i < ens.size(); i++) ens[i] /= sigma;
-      // future work: improve kurtosis correction
-      double kurtfact = 0.045;
-      for (size_t k = 0; k < 5; k++) {
-        for (i = 0; i < ens.size(); i++)
-          test_ensemble[i] = ens[i] - kurtfact * kurtosis * ens[i] * ens[i] * ens[i];
-        double test_value, test_sigma, test_skew, test_kurtosis;
-        double test_m5;
-        moments(test_ensemble, test_value, test_sigma, test_skew, test_kurtosis, test_m5);
-        kurtfact /= 1 - test_kurtosis / kurtosis;
-      }
-      for (i = 0; i < ens.size(); i++) ens[i] -= kurtosis * kurtfact * ens[i] * ens[i] * ens[i];
-    }
-    moments(ens, value, sigma, skew, kurtosis, m5);
-    for (i = 0; i < ens.size(); i++) ens[i] -= value;
-    for (i = 0; i < ens.size(); i++) ens[i] /= sigma;
-  }
+  static void PerfectEnsemble(std::vector<double> &ens) { perfect_ensemble(ens); }
 };
 
 }  // namespace uncertain
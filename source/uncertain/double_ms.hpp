@@ -46,6 +46,8 @@
 
 namespace uncertain {
 
+class MSBatchAccess;
+
 // model uncertain number using only mean and sigma (pure Gaussian)
 // This is the simplest possible model of uncertainty.  It ignores
 // all second-order and higher-order effects, and when two
@@ -58,6 +60,8 @@ class UDoubleMS {
   double value;        // the central (expected) value
   double uncertainty;  // the uncertainty (standard deviation)
 
+  friend class MSBatchAccess;
+
  public:
   // This is the default conversion from type double
   UDoubleMS(double val = 0.0, double unc = 0.0) : value(val), uncertainty(unc) {
@@ -66,7 +70,13 @@ class UDoubleMS {
     }
   }
 
-  UDoubleMS(const UDoubleMS &ud) : value(ud.value), uncertainty(ud.uncertainty) {}
+  UDoubleMS(const UDoubleMS &ud) = default;
+
+  UDoubleMS(UDoubleMS &&ud) noexcept = default;
+
+  UDoubleMS &operator=(const UDoubleMS &ud) = default;
+
+  UDoubleMS &operator=(UDoubleMS &&ud) noexcept = default;
 
   ~UDoubleMS() = default;
 
@@ -36,7 +36,6 @@
 
 #pragma once
 
-#include <functional>
 #include <sstream>
 #include <uncertain/functions.hpp>
 
@@ -72,7 +71,13 @@ class UDoubleMSC {
     }
   }
 
-  UDoubleMSC(const UDoubleMSC &ud) : value(ud.value), uncertainty(ud.uncertainty) {}
+  UDoubleMSC(const UDoubleMSC &ud) = default;
+
+  UDoubleMSC(UDoubleMSC &&ud) noexcept = default;
+
+  UDoubleMSC &operator=(const UDoubleMSC &ud) = default;
+
+  UDoubleMSC &operator=(UDoubleMSC &&ud) noexcept = default;
 
   ~UDoubleMSC() = default;
 
@@ -203,14 +208,18 @@ class UDoubleMSC {
     return is;
   }
 
-  static UDoubleMSC<is_correlated> func1(std::function<one_arg_ret(double)> func_w_moments,
-                                         UDoubleMSC<is_correlated> arg, std::string funcname) {
-    std::stringstream os;
-    os << funcname << "(" << arg << ") ";
+  template <class Func>
+  static UDoubleMSC<is_correlated> func1(Func func_w_moments, UDoubleMSC<is_correlated> arg,
+                                         const char *funcname) {
     one_arg_ret funcret = func_w_moments(arg.value);
+    if (near_discontinuity(arg.uncertainty, funcret.arg.disc_dist, funcret.arg.disc_type,
+                           UDoubleMSC<is_correlated>::discontinuity_thresh)) {
+      std::stringstream os;
+      os << funcname << "(" << arg << ") ";
+      gauss_loss(arg.uncertainty, funcret.arg.disc_dist, funcret.arg.disc_type, "", os.str(),
+                 UDoubleMSC<is_correlated>::discontinuity_thresh);
+    }
     arg.value = funcret.value + sqr(arg.uncertainty) * funcret.arg.curve / 2.0;
-    gauss_loss(arg.uncertainty, funcret.arg.disc_dist, funcret.arg.disc_type, "", os.str(),
-               UDoubleMSC<is_correlated>::discontinuity_thresh);
     if (funcret.arg.slope == 0.0)
       arg.uncertainty *= arg.uncertainty * funcret.arg.curve * k1Sqrt2;
     else {
@@ -224,22 +233,28 @@ class UDoubleMSC {
 
   // \todo enhance the below to account for moments with terms of each
   //  argument (e.g. for atan2(x,y), we now ignore d/dx(d/dy(atan2(x,y)))
-  static UDoubleMSC<is_correlated> func2(std::function<two_arg_ret(double, double)> func_w_moments,
-                                         const UDoubleMSC<is_correlated> arg1,
-                                         const UDoubleMSC<is_correlated> arg2,
-                                         std::string funcname) {
+  template <class Func>
+  static UDoubleMSC<is_correlated> func2(Func func_w_moments, const UDoubleMSC<is_correlated> &arg1,
+                                         const UDoubleMSC<is_correlated> &arg2,
+                                         const char *funcname) {
     UDoubleMSC<is_correlated> retval;
     double unc1, unc2;
-    std::stringstream os;
-    os << funcname << "(" << arg1 << ", " << arg2 << ") ";
-    std::string str = os.str();
     two_arg_ret funcret = func_w_moments(arg1.value, arg2.value);
     retval.value = funcret.value + 0.5 * (funcret.arg1.curve * sqr(arg1.uncertainty) +
                                           funcret.arg2.curve * sqr(arg2.uncertainty));
-    gauss_loss(arg1.uncertainty, funcret.arg1.disc_dist, funcret.arg1.disc_type, " on 1st argument",
-               str, UDoubleMSC<is_correlated>::discontinuity_thresh);
-    gauss_loss(arg2.uncertainty, funcret.arg2.disc_dist, funcret.arg2.disc_type, " on 2nd argument",
-               str, UDoubleMSC<is_correlated>::discontinuity_thresh);
+    const double thresh = UDoubleMSC<is_correlated>::discontinuity_thresh;
+    if (near_discontinuity(arg1.uncertainty, funcret.arg1.disc_dist, funcret.arg1.disc_type,
+                           thresh) ||
+        near_discontinuity(arg2.uncertainty, funcret.arg2.disc_dist, funcret.arg2.disc_type,
+                           thresh)) {
+      std::stringstream os;
+      os << funcname << "(" << arg1 << ", " << arg2 << ") ";
+      std::string str = os.str();
+      gauss_loss(arg1.uncertainty, funcret.arg1.disc_dist, funcret.arg1.disc_type,
+                 " on 1st argument", str, thresh);
+      gauss_loss(arg2.uncertainty, funcret.arg2.disc_dist, funcret.arg2.disc_type,
+                 " on 2nd argument", str, thresh);
+    }
     if (funcret.arg1.slope == 0.0)
       unc1 = sqr(arg1.uncertainty) * funcret.arg1.curve * k1Sqrt2;
     else
@@ -258,82 +273,82 @@ class UDoubleMSC {
   }
 
   friend UDoubleMSC<is_correlated> sqrt(UDoubleMSC<is_correlated> arg) {
-    return func1(&sqrt_w_moments, arg, "sqrt");
+    return func1(sqrt_w_moments_tag{}, arg, "sqrt");
   }
 
   friend UDoubleMSC<is_correlated> sin(UDoubleMSC<is_correlated> arg) {
-    return func1(&sin_w_moments, arg, "sin");
+    return func1(sin_w_moments_tag{}, arg, "sin");
   }
 
   friend UDoubleMSC<is_correlated> cos(UDoubleMSC<is_correlated> arg) {
-    return func1(&cos_w_moments, arg, "cos");
+    return func1(cos_w_moments_tag{}, arg, "cos");
   }
 
   friend UDoubleMSC<is_correlated> tan(UDoubleMSC<is_correlated> arg) {
-    return func1(&tan_w_moments, arg, "tan");
+    return func1(tan_w_moments_tag{}, arg, "tan");
   }
 
   friend UDoubleMSC<is_correlated> asin(UDoubleMSC<is_correlated> arg) {
-    return func1(&asin_w_moments, arg, "asin");
+    return func1(asin_w_moments_tag{}, arg, "asin");
   }
 
   friend UDoubleMSC<is_correlated> acos(UDoubleMSC<is_correlated> arg) {
-    return func1(&acos_w_moments, arg, "acos");
+    return func1(acos_w_moments_tag{}, arg, "acos");
   }
 
   friend UDoubleMSC<is_correlated> atan(UDoubleMSC<is_correlated> arg) {
-    return func1(&atan_w_moments, arg, "atan");
+    return func1(atan_w_moments_tag{}, arg, "atan");
   }
 
   friend UDoubleMSC<is_correlated> ceil(UDoubleMSC<is_correlated> arg) {
-    return func1(&ceil_w_moments, arg, "ceil");
+    return func1(ceil_w_moments_tag{}, arg, "ceil");
   }
 
   friend UDoubleMSC<is_correlated> floor(UDoubleMSC<is_correlated> arg) {
-    return func1(&floor_w_moments, arg, "floor");
+    return func1(floor_w_moments_tag{}, arg, "floor");
   }
 
   friend UDoubleMSC<is_correlated> fabs(UDoubleMSC<is_correlated> arg) {
-    return func1(&fabs_w_moments, arg, "fabs");
+    return func1(fabs_w_moments_tag{}, arg, "fabs");
   }
 
   friend UDoubleMSC<is_correlated> exp(UDoubleMSC<is_correlated> arg) {
-    return func1(&exp_w_moments, arg, "exp");
+    return func1(exp_w_moments_tag{}, arg, "exp");
   }
 
   friend UDoubleMSC<is_correlated> log(UDoubleMSC<is_correlated> arg) {
-    return func1(&log_w_moments, arg, "log");
+    return func1(log_w_moments_tag{}, arg, "log");
   }
 
   friend UDoubleMSC<is_correlated> log10(UDoubleMSC<is_correlated> arg) {
-    return func1(&log10_w_moments, arg, "sqrtlog10");
+    return func1(log10_w_moments_tag{}, arg, "sqrtlog10");
   }
 
   friend UDoubleMSC<is_correlated> sinh(UDoubleMSC<is_correlated> arg) {
-    return func1(&sinh_w_moments, arg, "sinh");
+    return func1(sinh_w_moments_tag{}, arg, "sinh");
   }
 
   friend UDoubleMSC<is_correlated> cosh(UDoubleMSC<is_correlated> arg) {
-    return func1(&cosh_w_moments, arg, "cosh");
+    return func1(cosh_w_moments_tag{}, arg, "cosh");
   }
 
   friend UDoubleMSC<is_correlated> tanh(UDoubleMSC<is_correlated> arg) {
-    return func1(&tanh_w_moments, arg, "tanh");
+    return func1(tanh_w_moments_tag{}, arg, "tanh");
   }
 
   friend UDoubleMSC<is_correlated> fmod(const UDoubleMSC<is_correlated> arg1,
                                         const UDoubleMSC<is_correlated> arg2) {
-    return func2(&fmod_w_moments, arg1, arg2, "fmod");
+    return func2(fmod_w_moments_tag{}, arg1, arg2, "fmod");
   }
 
   friend UDoubleMSC<is_correlated> atan2(const UDoubleMSC<is_correlated> arg1,
                                          const UDoubleMSC<is_correlated> arg2) {
-    return func2(&atan2_w_moments, arg1, arg2, "atan2");
+    return func2(atan2_w_moments_tag{}, arg1, arg2, "atan2");
   }
 
   friend UDoubleMSC<is_correlated> pow(const UDoubleMSC<is_correlated> arg1,
                                        const UDoubleMSC<is_correlated> arg2) {
-    return func2(&pow_w_moments, arg1, arg2, "pow");
+    return func2(pow_w_moments_tag{}, arg1, arg2, "pow");
   }
 
   friend UDoubleMSC<is_correlated> ldexp(UDoubleMSC<is_correlated> arg, const int intarg) {
@@ -0,0 +1,543 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// dynamic_ensemble.cpp: This file includes an ensemble uncertainty class
+// whose ensemble size is chosen at run time.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <uncertain/dynamic_ensemble.hpp>
+
+namespace uncertain {
+
+namespace {
+
+// the sources of uncertainty of the class and the settings for new ones
+struct DynamicTables {
+  std::mutex mutex;  // guards recipes, src_ensemble and bases
+  SourceSet sources{"Dynamic Ensemble"};
+  std::vector<EnsembleSourceRecipe> recipes;
+  std::vector<std::vector<double>> src_ensemble;
+  std::map<size_t, std::shared_ptr<const std::vector<double>>> bases;
+  std::atomic<size_t> ensemble_size{1024};
+  std::atomic<uint64_t> seed{0};
+  std::atomic<EnsembleSampling> sampling{EnsembleSampling::shuffled_basis};
+  std::atomic<bool> tracking{true};
+  std::atomic<size_t> parallel_threshold{kEnsembleSerial};
+};
+
+DynamicTables &tables() {
+  static DynamicTables tables;
+  return tables;
+}
+
+size_t threshold() { return tables().parallel_threshold.load(std::memory_order_relaxed); }
+
+// the Gaussian basis of n samples, made once for each size used
+std::shared_ptr<const std::vector<double>> gauss_basis(size_t n) {
+  DynamicTables &t = tables();
+  std::lock_guard<std::mutex> lock(t.mutex);
+  std::shared_ptr<const std::vector<double>> &basis = t.bases[n];
+  if (!basis) basis = std::make_shared<const std::vector<double>>(make_gauss_basis(n));
+  return basis;
+}
+
+void make_samples(const EnsembleSourceRecipe &recipe, size_t source_num, size_t n, double *x) {
+  std::shared_ptr<const std::vector<double>> gauss;
+  if (recipe.kind == EnsembleSourceRecipe::gaussian &&
+      recipe.sampling == EnsembleSampling::shuffled_basis)
+    gauss = gauss_basis(n);
+  make_recipe_samples(recipe, source_num, n, gauss ? gauss->data() : nullptr, x);
+}
+
+}  // namespace
+
+UDoubleDynamicEnsemble::UDoubleDynamicEnsemble(double val, double unc, const std::string &name)
+    : epoch(tables().sources.get_epoch()) {
+  if (unc < 0.0) {
+    throw std::runtime_error("Error: negative uncertainty: " + std::to_string(unc));
+  }
+
+  if (unc != 0.0) {
+    std::string source_name;
+    if (!name.empty()) {
+      source_name = name;
+    } else {
+      std::stringstream os;
+      os << "anon: ";
+      uncertain_print(val, unc, os);
+      source_name = os.str();
+    }
+    size_t source_num = tables().sources.get_new_source(source_name, epoch);
+    EnsembleSourceRecipe recipe;
+    recipe.kind = EnsembleSourceRecipe::gaussian;
+    recipe.offset = val;
+    recipe.scale = unc;
+    make_source(recipe, source_num);
+  } else  // uncertainty is zero
+    ensemble.assign(get_ensemble_size(), val);
+}
+
+UDoubleDynamicEnsemble::UDoubleDynamicEnsemble(std::vector<double> newensemble,
+                                               const std::string &name)
+    : epoch(tables().sources.get_epoch()) {
+  if (newensemble.size() != get_ensemble_size()) {
+    throw std::runtime_error("Cannot construct from wrong ensemble size");
+  }
+  ensemble = newensemble;
+  std::string source_name;
+  if (!name.empty()) {
+    source_name = name;
+  } else {
+    source_name = "anon from ensemble: " + std::to_string(ensemble[0]);
+  }
+  DynamicTables &t = tables();
+  size_t source_num = t.sources.get_new_source(source_name, epoch);
+  if (!get_source_tracking()) return;
+  // samples from elsewhere cannot be made again, so they are kept whole
+  std::lock_guard<std::mutex> lock(t.mutex);
+  if (source_num >= t.src_ensemble.size()) t.src_ensemble.resize(source_num + 1);
+  t.src_ensemble[source_num] = std::move(newensemble);
+  if (source_num >= t.recipes.size()) t.recipes.resize(source_num + 1);
+  t.recipes[source_num].kind = EnsembleSourceRecipe::samples;
+}
+
+UDoubleDynamicEnsemble::UDoubleDynamicEnsemble(const DistributionShape &shape, double offset,
+                                               double scale, const std::string &name)
+    : epoch(tables().sources.get_epoch()) {
+  size_t source_num = tables().sources.get_new_source(name, epoch);
+  EnsembleSourceRecipe recipe;
+  recipe.kind = EnsembleSourceRecipe::distribution;
+  recipe.shape = shape;
+  recipe.offset = offset;
+  recipe.scale = scale;
+  make_source(recipe, source_num);
+}
+
+void UDoubleDynamicEnsemble::make_source(EnsembleSourceRecipe recipe, size_t source_num) {
+  recipe.sampling = get_sampling();
+  recipe.seed = get_seed();
+  ensemble.resize(get_ensemble_size());
+  make_samples(recipe, source_num, ensemble.size(), samples());
+  if (!get_source_tracking()) return;
+  DynamicTables &t = tables();
+  std::lock_guard<std::mutex> lock(t.mutex);
+  if (source_num >= t.recipes.size()) t.recipes.resize(source_num + 1);
+  t.recipes[source_num] = recipe;
+}
+
+void UDoubleDynamicEnsemble::new_epoch() {
+  DynamicTables &t = tables();
+  std::lock_guard<std::mutex> lock(t.mutex);
+  t.sources.new_epoch();
+  t.src_ensemble = {};
+  t.recipes = {};
+}
+
+void UDoubleDynamicEnsemble::new_epoch(size_t ensemble_size) {
+  if (ensemble_size < 2)
+    throw std::runtime_error("Ensemble size " + std::to_string(ensemble_size) + " too small");
+  DynamicTables &t = tables();
+  std::lock_guard<std::mutex> lock(t.mutex);
+  // the size is set first, so values of the new epoch see it
+  t.ensemble_size.store(ensemble_size, std::memory_order_relaxed);
+  t.sources.new_epoch();
+  t.src_ensemble = {};
+  t.recipes = {};
+}
+
+size_t UDoubleDynamicEnsemble::get_ensemble_size() {
+  return tables().ensemble_size.load(std::memory_order_relaxed);
+}
+
+void UDoubleDynamicEnsemble::set_seed(uint64_t seed) {
+  tables().seed.store(seed, std::memory_order_relaxed);
+}
+
+uint64_t UDoubleDynamicEnsemble::get_seed() {
+  return tables().seed.load(std::memory_order_relaxed);
+}
+
+void UDoubleDynamicEnsemble::set_sampling(EnsembleSampling sampling) {
+  tables().sampling.store(sampling, std::memory_order_relaxed);
+}
+
+EnsembleSampling UDoubleDynamicEnsemble::get_sampling() {
+  return tables().sampling.load(std::memory_order_relaxed);
+}
+
+void UDoubleDynamicEnsemble::set_source_tracking(bool tracking) {
+  tables().tracking.store(tracking, std::memory_order_relaxed);
+}
+
+bool UDoubleDynamicEnsemble::get_source_tracking() {
+  return tables().tracking.load(std::memory_order_relaxed);
+}
+
+void UDoubleDynamicEnsemble::set_parallel_threshold(size_t threshold) {
+  tables().parallel_threshold.store(threshold, std::memory_order_relaxed);
+}
+
+size_t UDoubleDynamicEnsemble::get_parallel_threshold() { return threshold(); }
+
+size_t UDoubleDynamicEnsemble::num_tracked_sources() {
+  DynamicTables &t = tables();
+  std::lock_guard<std::mutex> lock(t.mutex);
+  return t.recipes.size();
+}
+
+std::string UDoubleDynamicEnsemble::get_source_name(size_t source_num) {
+  return tables().sources.get_source_name(source_num);
+}
+
+bool UDoubleDynamicEnsemble::source_samples(size_t source_num, double *x) {
+  DynamicTables &t = tables();
+  EnsembleSourceRecipe recipe;
+  {
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (source_num < t.recipes.size()) recipe = t.recipes[source_num];
+    if (recipe.kind == EnsembleSourceRecipe::samples) {
+      std::copy(t.src_ensemble[source_num].begin(), t.src_ensemble[source_num].end(), x);
+      return true;
+    }
+  }
+  if (recipe.kind == EnsembleSourceRecipe::none) return false;
+  make_samples(recipe, source_num, get_ensemble_size(), x);
+  return true;
+}
+
+std::vector<double> UDoubleDynamicEnsemble::source_samples(size_t source_num) {
+  std::vector<double> retval(get_ensemble_size());
+  if (!source_samples(source_num, retval.data())) return {};
+  return retval;
+}
+
+EnsembleStats UDoubleDynamicEnsemble::stats() const {
+  return stats_cache.get([this] {
+    return ensemble_stats(ensemble_moment_sums(ensemble.data(), size(), threshold()));
+  });
+}
+
+void UDoubleDynamicEnsemble::check_epochs(const UDoubleDynamicEnsemble &a,
+                                          const UDoubleDynamicEnsemble &b) {
+  tables().sources.check_epoch(a.epoch);
+  tables().sources.check_epoch(b.epoch);
+}
+
+UDoubleDynamicEnsemble UDoubleDynamicEnsemble::operator-() const {
+  UDoubleDynamicEnsemble retval(*this);
+  ensemble_apply(vec_negate, retval.samples(), retval.size(), threshold());
+  return retval;
+}
+
+UDoubleDynamicEnsemble operator+(UDoubleDynamicEnsemble a, const UDoubleDynamicEnsemble &b) {
+  a += b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator+(UDoubleDynamicEnsemble a, double b) {
+  a += b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator+(double b, UDoubleDynamicEnsemble a) {
+  a += b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator-(UDoubleDynamicEnsemble a, const UDoubleDynamicEnsemble &b) {
+  a -= b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator-(UDoubleDynamicEnsemble a, double b) {
+  a -= b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator-(double b, UDoubleDynamicEnsemble a) {
+  ensemble_apply(vec_rsub, a.samples(), b, a.size(), threshold());
+  return a;
+}
+
+UDoubleDynamicEnsemble operator*(UDoubleDynamicEnsemble a, const UDoubleDynamicEnsemble &b) {
+  a *= b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator*(UDoubleDynamicEnsemble a, double b) {
+  a *= b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator*(double b, UDoubleDynamicEnsemble a) {
+  a *= b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator/(UDoubleDynamicEnsemble a, const UDoubleDynamicEnsemble &b) {
+  a /= b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator/(UDoubleDynamicEnsemble a, double b) {
+  a /= b;
+  return a;
+}
+
+UDoubleDynamicEnsemble operator/(double a, UDoubleDynamicEnsemble b) {
+  ensemble_apply(vec_rdiv, b.samples(), a, b.size(), threshold());
+  return b;
+}
+
+UDoubleDynamicEnsemble &UDoubleDynamicEnsemble::operator+=(const UDoubleDynamicEnsemble &ud) {
+  check_epochs(*this, ud);
+  ensemble_apply(vec_add, samples(), ud.ensemble.data(), size(), threshold());
+  return *this;
+}
+
+UDoubleDynamicEnsemble &UDoubleDynamicEnsemble::operator+=(double d) {
+  ensemble_apply(vec_add, samples(), d, size(), threshold());
+  return *this;
+}
+
+UDoubleDynamicEnsemble &UDoubleDynamicEnsemble::operator-=(const UDoubleDynamicEnsemble &ud) {
+  check_epochs(*this, ud);
+  ensemble_apply(vec_sub, samples(), ud.ensemble.data(), size(), threshold());
+  return *this;
+}
+
+UDoubleDynamicEnsemble &UDoubleDynamicEnsemble::operator-=(double d) {
+  ensemble_apply(vec_sub, samples(), d, size(), threshold());
+  return *this;
+}
+
+UDoubleDynamicEnsemble &UDoubleDynamicEnsemble::operator*=(const UDoubleDynamicEnsemble &ud) {
+  check_epochs(*this, ud);
+  ensemble_apply(vec_mul, samples(), ud.ensemble.data(), size(), threshold());
+  return *this;
+}
+
+UDoubleDynamicEnsemble &UDoubleDynamicEnsemble::operator*=(double d) {
+  ensemble_apply(vec_mul, samples(), d, size(), threshold());
+  return *this;
+}
+
+UDoubleDynamicEnsemble &UDoubleDynamicEnsemble::operator/=(const UDoubleDynamicEnsemble &ud) {
+  check_epochs(*this, ud);
+  ensemble_apply(vec_div, samples(), ud.ensemble.data(), size(), threshold());
+  return *this;
+}
+
+UDoubleDynamicEnsemble &UDoubleDynamicEnsemble::operator/=(double d) {
+  ensemble_apply(vec_div, samples(), d, size(), threshold());
+  return *this;
+}
+
+std::ostream &operator<<(std::ostream &os, const UDoubleDynamicEnsemble &ud) {
+  print_ensemble_stats(ud.stats(), os);
+  return os;
+}
+
+std::istream &operator>>(std::istream &is, UDoubleDynamicEnsemble &ud) {
+  double mean, sigma;
+  uncertain_read(mean, sigma, is);
+  ud = UDoubleDynamicEnsemble(mean, sigma);
+  return is;
+}
+
+UDoubleDynamicEnsemble sqrt(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_sqrt, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble sin(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_sin, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble cos(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_cos, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble tan(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_tan, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble asin(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_asin, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble acos(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_acos, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble atan(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_atan, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble ceil(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_ceil, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble floor(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_floor, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble fabs(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_fabs, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble exp(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_exp, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble log(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_log, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble log10(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_log10, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble sinh(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_sinh, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble cosh(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_cosh, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble tanh(UDoubleDynamicEnsemble arg) {
+  ensemble_apply(vec_tanh, arg.samples(), arg.size(), threshold());
+  return arg;
+}
+
+UDoubleDynamicEnsemble fmod(UDoubleDynamicEnsemble arg1, const UDoubleDynamicEnsemble &arg2) {
+  UDoubleDynamicEnsemble::check_epochs(arg1, arg2);
+  ensemble_apply(vec_fmod, arg1.samples(), arg2.ensemble.data(), arg1.size(), threshold());
+  return arg1;
+}
+
+UDoubleDynamicEnsemble atan2(UDoubleDynamicEnsemble arg1, const UDoubleDynamicEnsemble &arg2) {
+  UDoubleDynamicEnsemble::check_epochs(arg1, arg2);
+  ensemble_apply(vec_atan2, arg1.samples(), arg2.ensemble.data(), arg1.size(), threshold());
+  return arg1;
+}
+
+UDoubleDynamicEnsemble pow(UDoubleDynamicEnsemble arg1, const UDoubleDynamicEnsemble &arg2) {
+  UDoubleDynamicEnsemble::check_epochs(arg1, arg2);
+  ensemble_apply(vec_pow, arg1.samples(), arg2.ensemble.data(), arg1.size(), threshold());
+  return arg1;
+}
+
+double UDoubleDynamicEnsemble::correlation(const UDoubleDynamicEnsemble &ud, size_t offset) const {
+  check_epochs(*this, ud);
+  return ensemble_correlation(ensemble.data(), ud.ensemble.data(), size(), offset);
+}
+
+double UDoubleDynamicEnsemble::correlation(const std::vector<double> &ens, size_t offset) const {
+  if (ens.size() != size()) {
+    throw std::runtime_error("Cannot correlate with wrong ensemble size");
+  }
+  return ensemble_correlation(ensemble.data(), ens.data(), size(), offset);
+}
+
+double UDoubleDynamicEnsemble::covariance(const UDoubleDynamicEnsemble &ud, size_t offset) const {
+  check_epochs(*this, ud);
+  return ensemble_covariance(ensemble.data(), ud.ensemble.data(), size(), offset);
+}
+
+std::vector<double> UDoubleDynamicEnsemble::lag_correlations(
+    const UDoubleDynamicEnsemble &ud) const {
+  check_epochs(*this, ud);
+  return uncertain::lag_correlations(ensemble.data(), ud.ensemble.data(), size());
+}
+
+std::vector<double> UDoubleDynamicEnsemble::lag_correlations(
+    const std::vector<double> &ens) const {
+  if (ens.size() != size()) {
+    throw std::runtime_error("Cannot correlate with wrong ensemble size");
+  }
+  return uncertain::lag_correlations(ensemble.data(), ens.data(), size());
+}
+
+Histogram UDoubleDynamicEnsemble::histogram(double low, double high, size_t bins) const {
+  return ensemble_histogram(ensemble.data(), size(), low, high, bins);
+}
+
+std::vector<double> UDoubleDynamicEnsemble::quantiles(
+    const std::vector<double> &probabilities) const {
+  return ensemble_quantiles(ensemble.data(), size(), probabilities);
+}
+
+std::pair<double, double> UDoubleDynamicEnsemble::credible_interval(double probability) const {
+  return ensemble_credible_interval(ensemble.data(), size(), probability);
+}
+
+void UDoubleDynamicEnsemble::print_histogram(std::ostream &os) const {
+  print_ensemble_histogram(ensemble.data(), size(), stats(), os);
+}
+
+EnsembleAttribution UDoubleDynamicEnsemble::attribute_sources() const {
+  tables().sources.check_epoch(epoch);
+  return attribute_samples(
+      ensemble.data(), size(), stats().mean, num_tracked_sources(),
+      [](size_t i, double *x) { return source_samples(i, x); }, tables().sources);
+}
+
+void UDoubleDynamicEnsemble::print_uncertain_sources(std::ostream &os) const {
+  print_ensemble_sources(deviation(), [this] { return attribute_sources(); }, os);
+}
+
+void UDoubleDynamicEnsemble::shuffle() { shuffle_values(samples(), size(), thread_engine()); }
+
+}  // namespace uncertain
@@ -0,0 +1,260 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// dynamic_ensemble.hpp: This file includes an ensemble uncertainty class
+// whose ensemble size is chosen at run time.
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <uncertain/double_ensemble.hpp>
+#include <utility>
+#include <vector>
+
+namespace uncertain {
+
+// Ensemble uncertainty class like UDoubleEnsemble<>, with the ensemble
+// size chosen when an epoch starts instead of at compile time, so it can
+// be read from a configuration or grown until the moments converge.  It
+// uses the same kernels, bases and recipes; being a single class, all its
+// code is compiled once into the library whatever the sizes used.
+//
+// The sources of uncertainty are kept by the class, as for the other
+// uncertainty classes, and all values of an epoch have the size it was
+// started with.  Start epochs while no values are being made.
+class UDoubleDynamicEnsemble {
+ public:
+  // The main constructor initializes a new source of uncertainty
+  // (if there is uncertainty).
+  UDoubleDynamicEnsemble(double val = 0.0, double unc = 0.0, const std::string &name = {});
+
+  // constructor from an ensemble of get_ensemble_size() samples, kept
+  // whole in the table of sources
+  UDoubleDynamicEnsemble(std::vector<double> newensemble, const std::string &name = {});
+
+  // constructor from a distribution of distributions.hpp, e.g.
+  // UDoubleDynamicEnsemble(Uniform(0.0, 1.0)), a new source of uncertainty
+  template <class Distribution, class = decltype(std::declval<const Distribution &>().shape())>
+  explicit UDoubleDynamicEnsemble(const Distribution &dist, const std::string &name = {})
+      : UDoubleDynamicEnsemble(dist.shape(), dist.offset(), dist.scale(),
+                               name.empty() ? dist.name() : name) {}
+
+  UDoubleDynamicEnsemble(const UDoubleDynamicEnsemble &ud) = default;
+  UDoubleDynamicEnsemble(UDoubleDynamicEnsemble &&ud) noexcept = default;
+  UDoubleDynamicEnsemble &operator=(const UDoubleDynamicEnsemble &ud) = default;
+  UDoubleDynamicEnsemble &operator=(UDoubleDynamicEnsemble &&ud) noexcept = default;
+  ~UDoubleDynamicEnsemble() = default;
+
+  // Starts a new epoch, which invalidates all values, optionally with a
+  // new ensemble size.
+  static void new_epoch();
+  static void new_epoch(size_t ensemble_size);
+
+  // the ensemble size of the current epoch, 1024 until one is chosen
+  static size_t get_ensemble_size();
+
+  // as for UDoubleEnsemble<>
+  static void set_seed(uint64_t seed);
+  static uint64_t get_seed();
+  static void set_sampling(EnsembleSampling sampling);
+  static EnsembleSampling get_sampling();
+  static void set_source_tracking(bool tracking);
+  static bool get_source_tracking();
+  static void set_parallel_threshold(size_t threshold);
+  static size_t get_parallel_threshold();
+
+  // the number of sources kept since the last new_epoch()
+  static size_t num_tracked_sources();
+
+  // the name given to source number source_num
+  static std::string get_source_name(size_t source_num);
+
+  // Writes the samples of source number source_num, made again from its
+  // recipe, to x.  Returns false if the source is not tracked.
+  static bool source_samples(size_t source_num, double *x);
+
+  // The samples of source number source_num; empty if it is not tracked.
+  static std::vector<double> source_samples(size_t source_num);
+
+  size_t size() const { return ensemble.size(); }
+
+  // the samples, for reading
+  const double *data() const { return ensemble.data(); }
+
+  double mean() const { return stats().mean; }
+
+  double deviation() const { return stats().deviation; }
+
+  // the mean, deviation and higher moments together, from a single pass
+  // over the samples the first time they are asked for after a change
+  EnsembleStats stats() const;
+
+  UDoubleDynamicEnsemble operator+() const { return *this; }
+
+  UDoubleDynamicEnsemble operator-() const;
+
+  // The binary operators take their left operand by value, so a temporary
+  // on the left is moved in and its samples are updated in place.
+  friend UDoubleDynamicEnsemble operator+(UDoubleDynamicEnsemble a,
+                                          const UDoubleDynamicEnsemble &b);
+  friend UDoubleDynamicEnsemble operator+(UDoubleDynamicEnsemble a, double b);
+  friend UDoubleDynamicEnsemble operator+(double b, UDoubleDynamicEnsemble a);
+  friend UDoubleDynamicEnsemble operator-(UDoubleDynamicEnsemble a,
+                                          const UDoubleDynamicEnsemble &b);
+  friend UDoubleDynamicEnsemble operator-(UDoubleDynamicEnsemble a, double b);
+  friend UDoubleDynamicEnsemble operator-(double b, UDoubleDynamicEnsemble a);
+  friend UDoubleDynamicEnsemble operator*(UDoubleDynamicEnsemble a,
+                                          const UDoubleDynamicEnsemble &b);
+  friend UDoubleDynamicEnsemble operator*(UDoubleDynamicEnsemble a, double b);
+  friend UDoubleDynamicEnsemble operator*(double b, UDoubleDynamicEnsemble a);
+  friend UDoubleDynamicEnsemble operator/(UDoubleDynamicEnsemble a,
+                                          const UDoubleDynamicEnsemble &b);
+  friend UDoubleDynamicEnsemble operator/(UDoubleDynamicEnsemble a, double b);
+  friend UDoubleDynamicEnsemble operator/(double a, UDoubleDynamicEnsemble b);
+
+  UDoubleDynamicEnsemble &operator+=(const UDoubleDynamicEnsemble &ud);
+  UDoubleDynamicEnsemble &operator+=(double d);
+  UDoubleDynamicEnsemble &operator-=(const UDoubleDynamicEnsemble &ud);
+  UDoubleDynamicEnsemble &operator-=(double d);
+  UDoubleDynamicEnsemble &operator*=(const UDoubleDynamicEnsemble &ud);
+  UDoubleDynamicEnsemble &operator*=(double d);
+  UDoubleDynamicEnsemble &operator/=(const UDoubleDynamicEnsemble &ud);
+  UDoubleDynamicEnsemble &operator/=(double d);
+
+  friend std::ostream &operator<<(std::ostream &os, const UDoubleDynamicEnsemble &ud);
+  friend std::istream &operator>>(std::istream &is, UDoubleDynamicEnsemble &ud);
+
+  // Applies func to every sample.  func may be any callable, e.g. sin_tag{}
+  // or a lambda.  From the parallel threshold up it is called on several
+  // threads at once.
+  template <class Func>
+  static UDoubleDynamicEnsemble func1(Func func, UDoubleDynamicEnsemble arg) {
+    double *x = arg.samples();
+    for_samples(arg.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) x[i] = func(x[i]);
+    });
+    return arg;
+  }
+
+  template <class Func>
+  static UDoubleDynamicEnsemble func2(Func func, const UDoubleDynamicEnsemble &arg1,
+                                      const UDoubleDynamicEnsemble &arg2) {
+    check_epochs(arg1, arg2);
+    UDoubleDynamicEnsemble retval(arg1);
+    double *x = retval.samples();
+    for_samples(retval.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) x[i] = func(arg1.ensemble[i], arg2.ensemble[i]);
+    });
+    return retval;
+  }
+
+  friend UDoubleDynamicEnsemble sqrt(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble sin(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble cos(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble tan(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble asin(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble acos(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble atan(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble ceil(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble floor(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble fabs(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble exp(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble log(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble log10(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble sinh(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble cosh(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble tanh(UDoubleDynamicEnsemble arg);
+  friend UDoubleDynamicEnsemble fmod(UDoubleDynamicEnsemble arg1,
+                                     const UDoubleDynamicEnsemble &arg2);
+  friend UDoubleDynamicEnsemble atan2(UDoubleDynamicEnsemble arg1,
+                                      const UDoubleDynamicEnsemble &arg2);
+  friend UDoubleDynamicEnsemble pow(UDoubleDynamicEnsemble arg1,
+                                    const UDoubleDynamicEnsemble &arg2);
+
+  double correlation(const UDoubleDynamicEnsemble &ud, size_t offset = 0) const;
+  double correlation(const std::vector<double> &ens, size_t offset = 0) const;
+
+  // the covariance of the samples, over the ensemble size as the deviation
+  double covariance(const UDoubleDynamicEnsemble &ud, size_t offset = 0) const;
+
+  // correlation(ud, offset) for every offset
+  std::vector<double> lag_correlations(const UDoubleDynamicEnsemble &ud) const;
+  std::vector<double> lag_correlations(const std::vector<double> &ens) const;
+
+  Histogram histogram(double low, double high, size_t bins) const;
+  double quantile(double p) const { return quantiles({p}).front(); }
+  std::vector<double> quantiles(const std::vector<double> &probabilities) const;
+  std::pair<double, double> credible_interval(double probability = 0.95) const;
+  void print_histogram(std::ostream &os = std::cout) const;
+
+  // The share of the variance of this value due to each tracked source of
+  // uncertainty.
+  EnsembleAttribution attribute_sources() const;
+
+  void print_uncertain_sources(std::ostream &os = std::cout) const;
+
+  // shuffles the samples with the calling thread's generator
+  void shuffle();
+
+ private:
+  size_t epoch;
+  std::vector<double> ensemble;
+  EnsembleStatsCache stats_cache;
+
+  UDoubleDynamicEnsemble(const DistributionShape &shape, double offset, double scale,
+                         const std::string &name);
+
+  // starts a new source by the recipe, of the size of the epoch
+  void make_source(EnsembleSourceRecipe recipe, size_t source_num);
+
+  // the samples for writing; the cached statistics no longer apply
+  double *samples() {
+    stats_cache.invalidate();
+    return ensemble.data();
+  }
+
+  static void check_epochs(const UDoubleDynamicEnsemble &a, const UDoubleDynamicEnsemble &b);
+
+  // body(begin, end) over n samples, split across threads from the
+  // parallel threshold up
+  template <class Body>
+  static void for_samples(size_t n, const Body &body) {
+    if (n < get_parallel_threshold())
+      body(size_t(0), n);
+    else
+      parallel_for(n, kEnsembleMinChunk, body);
+  }
+};
+
+}  // namespace uncertain
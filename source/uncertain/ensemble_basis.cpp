@@ -0,0 +1,140 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ensemble_basis.cpp: This file includes the construction of the normalized
+// Gaussian basis of the ensemble classes and the moments used to shape it.
+
+#include <cmath>
+#include <limits>
+#include <uncertain/ensemble_basis.hpp>
+#include <uncertain/kernels.hpp>
+
+namespace uncertain {
+
+void moments_from_sums(size_t n, const double *sums, double &sigma, double &skew,
+                       double &kurtosis, double &m5) {
+  double var = sums[1] / n;
+  sigma = std::sqrt(var);
+  skew = sums[2] / (var * sigma * n);
+  kurtosis = sums[3] / (var * var * n) - 3;
+  m5 = sums[4] / (var * var * sigma * n);
+}
+
+void ensemble_moments(const double *samples, size_t n, double &mean, double &sigma, double &skew,
+                      double &kurtosis, double &m5) {
+  mean = vec_sum(samples, n) / n;
+  double sums[5];
+  vec_power_sums(samples, n, mean, 5, sums);
+
+  // The sum of the differences corrects for the rounding of the mean.
+  // Shift the other power sums to the corrected mean by the binomial
+  // expansion instead of making another pass.
+  double delta = sums[0] / n;
+  mean += delta;
+  double power_sums[6] = {double(n), sums[0], sums[1], sums[2], sums[3], sums[4]};
+  double shifted[5] = {0.0};
+  for (size_t k = 2; k <= 5; k++) {
+    double binomial = 1.0, delta_power = 1.0;  // (k choose j) and (-delta)^(k - j)
+    for (size_t j = k;; j--) {
+      shifted[k - 1] += binomial * delta_power * power_sums[j];
+      if (j == 0) break;
+      binomial = binomial * j / (k - j + 1);
+      delta_power *= -delta;
+    }
+  }
+  moments_from_sums(n, shifted, sigma, skew, kurtosis, m5);
+}
+
+void perfect_ensemble(std::vector<double> &ens) {
+  size_t i;
+  double value, sigma, skew, kurtosis, m5;
+
+  std::vector<double> test_ensemble;
+  test_ensemble.resize(ens.size());
+  for (int j = 0; j < 3; j++) {
+    ensemble_moments(ens.data(), ens.size(), value, sigma, skew, kurtosis, m5);
+
+    for (i = 0; i < ens.size(); i++) ens[i] -= value;
+    for (i = 0; i < ens.size(); i++) ens[i] /= sigma;
+    // The kurtosis is known only to the rounding of the 3 it is taken
+    // from; the secant steps below divide by nothing but noise there.
+    const double kurtosis_resolution = 16 * std::numeric_limits<double>::epsilon();
+    if (std::fabs(kurtosis) < kurtosis_resolution) continue;
+    // future work: improve kurtosis correction
+    double kurtfact = 0.045;
+    for (size_t k = 0; k < 5; k++) {
+      for (i = 0; i < ens.size(); i++)
+        test_ensemble[i] = ens[i] - kurtfact * kurtosis * ens[i] * ens[i] * ens[i];
+      double test_value, test_sigma, test_skew, test_kurtosis;
+      double test_m5;
+      ensemble_moments(test_ensemble.data(), test_ensemble.size(), test_value, test_sigma,
+                       test_skew, test_kurtosis, test_m5);
+      if (std::fabs(test_kurtosis) < kurtosis_resolution) break;
+      kurtfact /= 1 - test_kurtosis / kurtosis;
+    }
+    for (i = 0; i < ens.size(); i++) ens[i] -= kurtosis * kurtfact * ens[i] * ens[i] * ens[i];
+  }
+  ensemble_moments(ens.data(), ens.size(), value, sigma, skew, kurtosis, m5);
+  for (i = 0; i < ens.size(); i++) ens[i] -= value;
+  for (i = 0; i < ens.size(); i++) ens[i] /= sigma;
+}
+
+std::vector<double> compute_gauss_basis(size_t n) {
+  // Each point is the mean of the normal distribution over one of n slices
+  // of equal probability: between the quantiles z_i and z_i+1 at i / n it
+  // is n (phi(z_i) - phi(z_i+1)), with phi the density.  Only the lower
+  // half is needed; the upper half mirrors it, with 0 in the middle for
+  // odd n.
+  size_t half = n / 2;
+  std::vector<double> z(half + 1);
+  for (size_t i = 0; i <= half; i++) z[i] = double(i) / n;
+  vec_inverse_normal_cdf(z.data(), z.size());
+
+  const double inv_sqrt_2pi = 0.39894228040143267794;
+  std::vector<double> basis(n, 0.0);
+  for (size_t i = 0; i < half; i++) {
+    // phi(z_i+1) - phi(z_i) as phi(z_i+1) (1 - exp((z_i+1^2 - z_i^2) / 2)),
+    // which does not cancel for the close boundaries near the middle
+    double density = inv_sqrt_2pi * std::exp(-0.5 * z[i + 1] * z[i + 1]);
+    double deviate = density;
+    if (i > 0) deviate *= -std::expm1(0.5 * (z[i + 1] - z[i]) * (z[i + 1] + z[i]));
+    deviate *= n;
+    basis[2 * i] = deviate;
+    basis[2 * i + 1] = -deviate;
+  }
+  // Move the points a little to make all the first 5 moments give
+  // exact values.
+  perfect_ensemble(basis);
+  return basis;
+}
+
+}  // namespace uncertain
@@ -0,0 +1,94 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ensemble_basis.hpp: This file includes the normalized Gaussian basis
+// the ensemble classes draw their samples from, the moments used to
+// shape it, and the tables and on-disk cache that save rebuilding it.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace uncertain {
+
+// Bumped whenever the construction of the basis changes, so that files
+// cached by an older version are not used.
+constexpr unsigned kGaussBasisVersion = 2;
+
+// figure the moments (sigma, skew, kurtosis, & 5th moment) from the
+// sums of the 2nd to 5th powers of the differences from the mean.
+void moments_from_sums(size_t n, const double *sums, double &sigma, double &skew,
+                       double &kurtosis, double &m5);
+
+// figure the moments (mean, sigma, skew, kurtosis, & 5th moment) of n
+// samples in two compensated passes.
+void ensemble_moments(const double *samples, size_t n, double &mean, double &sigma, double &skew,
+                      double &kurtosis, double &m5);
+
+// This function moves points a little bit so the first 5 moments all
+// get measured at precisely the expected values.
+void perfect_ensemble(std::vector<double> &ens);
+
+// Builds the basis of n points from scratch: the means of n slices of
+// equal probability, as +/- pairs, then perfected.
+std::vector<double> compute_gauss_basis(size_t n);
+
+// The basis of n points built along with the library, or nullptr if n is
+// not one of the sizes in UNCERTAIN_BASIS_TABLE_SIZES.
+const double *precomputed_gauss_basis(size_t n);
+
+// The basis of n points from the built-in tables, else from the on-disk
+// cache, else computed and then saved to the cache for later processes.
+std::vector<double> make_gauss_basis(size_t n);
+
+// The directory of the on-disk cache: the one set below, else the
+// UNCERTAIN_CACHE_DIR environment variable.  Empty, the default, if caching
+// is disabled, so nothing is written unless a directory is chosen.
+std::string gauss_basis_cache_dir();
+
+// Overrides the cache directory; an empty dir disables the cache.
+void set_gauss_basis_cache_dir(const std::string &dir);
+
+// The cache file for the basis of n points in dir.
+std::string gauss_basis_cache_file(const std::string &dir, size_t n);
+
+// Reads the basis of n points from a cache file.  Returns false if the
+// file is missing, of another version or size, or corrupt.
+bool read_gauss_basis_file(const std::string &path, size_t n, std::vector<double> &basis);
+
+// Writes a basis to a cache file, atomically so that concurrent processes
+// only ever see whole files.  Returns false on failure.
+bool write_gauss_basis_file(const std::string &path, const std::vector<double> &basis);
+
+}  // namespace uncertain
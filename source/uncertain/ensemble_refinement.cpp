@@ -0,0 +1,112 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ensemble_refinement.cpp: This file includes the choice of the ensemble
+// size of a computation by running it with more samples until its result
+// is precise enough.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <stdexcept>
+#include <uncertain/ensemble_refinement.hpp>
+
+namespace uncertain {
+
+void replicate_errors(const std::vector<EnsembleStats> &runs, double &mean_error,
+                      double &deviation_error) {
+  mean_error = deviation_error = 0.0;
+  if (runs.size() < 2) return;
+  double mean = 0.0, deviation = 0.0;
+  for (const EnsembleStats &run : runs) {
+    mean += run.mean;
+    deviation += run.deviation;
+  }
+  mean /= runs.size();
+  deviation /= runs.size();
+  for (const EnsembleStats &run : runs) {
+    mean_error += (run.mean - mean) * (run.mean - mean);
+    deviation_error += (run.deviation - deviation) * (run.deviation - deviation);
+  }
+  mean_error = std::sqrt(mean_error / (runs.size() - 1));
+  deviation_error = std::sqrt(deviation_error / (runs.size() - 1));
+}
+
+RefinementResult refine_ensemble_size(const std::function<UDoubleDynamicEnsemble()> &compute,
+                                      const RefinementOptions &options) {
+  if (options.initial_size < 2 || options.growth < 2 || options.max_size < options.initial_size ||
+      options.replicates < 2)
+    throw std::runtime_error("refine_ensemble_size() needs 2 <= initial_size <= max_size, "
+                             "growth >= 2, replicates >= 2");
+
+  const uint64_t seed = UDoubleDynamicEnsemble::get_seed();
+  RefinementResult retval;
+  for (size_t n = options.initial_size;;) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<EnsembleStats> runs(options.replicates);
+    // the run with the starting seed goes last, so its epoch stays current
+    for (size_t r = options.replicates; r-- > 0;) {
+      UDoubleDynamicEnsemble::set_seed(seed + r);
+      UDoubleDynamicEnsemble::new_epoch(n);
+      retval.value = compute();
+      runs[r] = retval.value.stats();
+    }
+    RefinementStage stage;
+    stage.ensemble_size = n;
+    stage.stats = runs[0];
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    stage.seconds = elapsed.count();
+    replicate_errors(runs, stage.mean_error, stage.deviation_error);
+    retval.stages.push_back(stage);
+
+    const double sigma = stage.stats.deviation;
+    retval.converged = stage.mean_error <= options.mean_tolerance * sigma &&
+                       stage.deviation_error <= options.deviation_tolerance * sigma;
+    if (retval.converged || n > options.max_size / options.growth) break;
+    n *= options.growth;
+  }
+  return retval;
+}
+
+void RefinementResult::print(std::ostream &os) const {
+  auto original_precision = os.precision();
+  for (const RefinementStage &stage : stages) {
+    os << std::setw(8) << stage.ensemble_size << ": ";
+    uncertain_print(stage.stats.mean, stage.stats.deviation, os);
+    os << "  errors " << std::setprecision(2) << stage.mean_error << ", " << stage.deviation_error
+       << "  " << stage.seconds << " s" << std::setprecision(original_precision) << std::endl;
+  }
+  os << (converged ? "converged" : "not converged") << std::endl;
+}
+
+}  // namespace uncertain
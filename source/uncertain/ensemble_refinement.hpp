@@ -0,0 +1,97 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ensemble_refinement.hpp: This file includes the choice of the ensemble
+// size of a computation by running it with more samples until its result
+// is precise enough.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <uncertain/dynamic_ensemble.hpp>
+#include <vector>
+
+namespace uncertain {
+
+struct RefinementOptions {
+  size_t initial_size = 256;
+  size_t max_size = 65536;
+  size_t growth = 2;  // the factor between the sizes of successive stages
+
+  // The number of runs at each size, each with its own seed.  The spread of
+  // their results measures the sampling error of one run, whatever the
+  // sampling method.  At least 2.
+  size_t replicates = 4;
+
+  // The target errors of the mean and of the deviation of the result,
+  // relative to its deviation.
+  double mean_tolerance = 0.01;
+  double deviation_tolerance = 0.01;
+};
+
+// One run of the computation, at one ensemble size.
+struct RefinementStage {
+  size_t ensemble_size = 0;
+  EnsembleStats stats;            // of the run with the starting seed
+  double mean_error = 0.0;       // the spread of the mean over the replicate runs
+  double deviation_error = 0.0;  // and of the deviation
+  double seconds = 0.0;          // wall time of all the runs
+};
+
+struct RefinementResult {
+  UDoubleDynamicEnsemble value;  // the result of the last stage
+  std::vector<RefinementStage> stages;
+  bool converged = false;  // whether the last stage met the tolerances
+
+  // a line for each stage: its size, result, errors and time
+  void print(std::ostream &os = std::cout) const;
+};
+
+// The sample standard deviations of the means and of the deviations of
+// replicate runs of one computation.
+void replicate_errors(const std::vector<EnsembleStats> &runs, double &mean_error,
+                      double &deviation_error);
+
+// Runs compute, which makes its inputs with the UDoubleDynamicEnsemble
+// constructors and returns its result, replicates times in new epochs of
+// initial_size samples with seeds get_seed(), get_seed() + 1, ..., then
+// again with growth times as many samples each time until the spread of the
+// results meets the tolerances or the size would exceed max_size.  Easy
+// computations, e.g. linear ones under stratified sampling, stop at a small
+// size; the stages before the last cost at most 1 / (growth - 1) of it.
+// The result is the run with the starting seed, which is left set.
+RefinementResult refine_ensemble_size(const std::function<UDoubleDynamicEnsemble()> &compute,
+                                      const RefinementOptions &options = {});
+
+}  // namespace uncertain
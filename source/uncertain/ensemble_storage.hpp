@@ -0,0 +1,222 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ensemble_storage.hpp: This file includes storage policies for the
+// samples of the ensemble uncertainty class UDoubleEnsemble<>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace uncertain {
+
+// Sample blocks are aligned to a cache line, which is also enough for the
+// widest vector loads used by the ensemble kernels.
+constexpr size_t kEnsembleAlignment = 64;
+
+// Largest ensemble (in samples) kept inline by DefaultEnsembleStorage.
+// Bigger ensembles would make every by-value temporary a large stack copy.
+constexpr size_t kInlineEnsembleLimit = 256;
+
+// Each storage policy holds exactly ensemble_size doubles and has only
+// those members needed by UDoubleEnsemble<>: data(), size(), operator[]
+// and begin()/end().  Sample values are not initialized.  A moved-from
+// storage still holds ensemble_size doubles, of unspecified values.
+
+// Heap storage: one std::vector allocation per ensemble.
+template <size_t ensemble_size>
+class HeapStorage {
+ private:
+  std::vector<double> elements;
+
+ public:
+  HeapStorage() : elements(ensemble_size) {}
+
+  HeapStorage(const HeapStorage &other) = default;
+
+  // the moved-from storage gets a new vector of its own
+  HeapStorage(HeapStorage &&other) : HeapStorage() { elements.swap(other.elements); }
+
+  HeapStorage &operator=(const HeapStorage &other) = default;
+
+  HeapStorage &operator=(HeapStorage &&other) noexcept {
+    elements.swap(other.elements);
+    return *this;
+  }
+
+  double *data() { return elements.data(); }
+  const double *data() const { return elements.data(); }
+  static constexpr size_t size() { return ensemble_size; }
+
+  double &operator[](size_t i) { return elements[i]; }
+  double operator[](size_t i) const { return elements[i]; }
+
+  double *begin() { return data(); }
+  double *end() { return data() + ensemble_size; }
+  const double *begin() const { return data(); }
+  const double *end() const { return data() + ensemble_size; }
+};
+
+// Inline storage: the samples live inside the object, so constructing and
+// copying an ensemble never allocates.  Meant for small ensemble sizes.
+template <size_t ensemble_size>
+class InlineStorage {
+ private:
+  alignas(kEnsembleAlignment) std::array<double, ensemble_size> elements;
+
+ public:
+  double *data() { return elements.data(); }
+  const double *data() const { return elements.data(); }
+  static constexpr size_t size() { return ensemble_size; }
+
+  double &operator[](size_t i) { return elements[i]; }
+  double operator[](size_t i) const { return elements[i]; }
+
+  double *begin() { return data(); }
+  double *end() { return data() + ensemble_size; }
+  const double *begin() const { return data(); }
+  const double *end() const { return data() + ensemble_size; }
+};
+
+// Per-thread cache of aligned blocks of block_size doubles.  Released
+// blocks are kept for reuse (up to kCapacity of them) instead of being
+// returned to the allocator, so short-lived ensemble temporaries recycle
+// the same few blocks.  A block may be released on another thread than
+// the one that acquired it.
+template <size_t block_size>
+class EnsemblePool {
+ public:
+  static double *acquire() {
+    Cache &c = cache();
+    if (c.count > 0) return c.blocks[--c.count];
+    return static_cast<double *>(
+        ::operator new(block_size * sizeof(double), std::align_val_t(kEnsembleAlignment)));
+  }
+
+  static void release(double *block) {
+    Cache &c = cache();
+    if (!c.closed && (c.count < kCapacity))
+      c.blocks[c.count++] = block;
+    else
+      free_block(block);
+  }
+
+  // number of blocks cached by the calling thread
+  static size_t cached() { return cache().count; }
+
+ private:
+  static constexpr size_t kCapacity = 64;
+
+  // Trivially destructible, so it stays usable while thread-local and
+  // static objects are being destroyed.
+  struct Cache {
+    double *blocks[kCapacity];
+    size_t count;
+    bool closed;
+  };
+
+  // Frees the cached blocks at thread exit.  Blocks released later go
+  // straight back to the allocator.
+  struct Reaper {
+    ~Reaper() {
+      Cache &c = cache();
+      while (c.count > 0) free_block(c.blocks[--c.count]);
+      c.closed = true;
+    }
+  };
+
+  static void free_block(double *block) {
+    ::operator delete(block, std::align_val_t(kEnsembleAlignment));
+  }
+
+  static Cache &cache() {
+    thread_local Cache c{};
+    thread_local Reaper reaper;
+    (void)reaper;
+    return c;
+  }
+};
+
+// Pooled storage: the samples live in a block taken from EnsemblePool<>.
+// Objects stay small, and moves hand the block over: a moved-from object
+// takes another block, usually a cached one.  Meant for large ensemble
+// sizes.
+template <size_t ensemble_size>
+class PooledStorage {
+ private:
+  double *elements;
+
+ public:
+  PooledStorage() : elements(EnsemblePool<ensemble_size>::acquire()) {}
+
+  PooledStorage(const PooledStorage &other) : PooledStorage() {
+    std::copy(other.begin(), other.end(), elements);
+  }
+
+  PooledStorage(PooledStorage &&other) : PooledStorage() { std::swap(elements, other.elements); }
+
+  PooledStorage &operator=(const PooledStorage &other) {
+    if (this != &other) std::copy(other.begin(), other.end(), elements);
+    return *this;
+  }
+
+  PooledStorage &operator=(PooledStorage &&other) noexcept {
+    std::swap(elements, other.elements);
+    return *this;
+  }
+
+  ~PooledStorage() { EnsemblePool<ensemble_size>::release(elements); }
+
+  double *data() { return elements; }
+  const double *data() const { return elements; }
+  static constexpr size_t size() { return ensemble_size; }
+
+  double &operator[](size_t i) { return elements[i]; }
+  double operator[](size_t i) const { return elements[i]; }
+
+  double *begin() { return elements; }
+  double *end() { return elements + ensemble_size; }
+  const double *begin() const { return elements; }
+  const double *end() const { return elements + ensemble_size; }
+};
+
+// Inline storage for small ensembles, pooled storage for large ones.
+template <size_t ensemble_size>
+using DefaultEnsembleStorage =
+    std::conditional_t<(ensemble_size <= kInlineEnsembleLimit), InlineStorage<ensemble_size>,
+                       PooledStorage<ensemble_size>>;
+
+}  // namespace uncertain
@@ -36,6 +36,7 @@
 
 #include <iomanip>
 #include <uncertain/functions.hpp>
+#include <uncertain/kernels.hpp>
 
 namespace uncertain {
 
@@ -112,4 +113,9 @@ void gauss_loss(double uncertainty, double disc_dist, const discontinuity_type &
   }
 }
 
+double inverse_normal_cdf(double p) {
+  vec_inverse_normal_cdf(&p, 1);
+  return p;
+}
+
 }  // namespace uncertain
@@ -448,9 +448,86 @@ inline two_arg_ret pow_w_moments(double arg1, double arg2) {
   return retval;
 }
 
-// This function returns an approximation of the inverse Gaussian denstity
-// function to within 4.5e-4.  From Abromowitz & Stegun's _Handbook_of_
-// _Mathematical_Functions_ formula 26.2.23
+// Function tags: empty callable types naming a function at compile time.
+// Passing one of these to func1()/func2() of the uncertain classes lets the
+// compiler inline the call, where a std::function or a function pointer
+// would force an indirect call per operation (or per ensemble sample).
+template <auto function>
+struct function_tag {
+  template <class... Args>
+  auto operator()(Args... args) const {
+    return function(args...);
+  }
+};
+
+using sqrt_w_moments_tag = function_tag<&sqrt_w_moments>;
+using sin_w_moments_tag = function_tag<&sin_w_moments>;
+using cos_w_moments_tag = function_tag<&cos_w_moments>;
+using tan_w_moments_tag = function_tag<&tan_w_moments>;
+using asin_w_moments_tag = function_tag<&asin_w_moments>;
+using acos_w_moments_tag = function_tag<&acos_w_moments>;
+using atan_w_moments_tag = function_tag<&atan_w_moments>;
+using ceil_w_moments_tag = function_tag<&ceil_w_moments>;
+using floor_w_moments_tag = function_tag<&floor_w_moments>;
+using fabs_w_moments_tag = function_tag<&fabs_w_moments>;
+using exp_w_moments_tag = function_tag<&exp_w_moments>;
+using log_w_moments_tag = function_tag<&log_w_moments>;
+using log10_w_moments_tag = function_tag<&log10_w_moments>;
+using sinh_w_moments_tag = function_tag<&sinh_w_moments>;
+using cosh_w_moments_tag = function_tag<&cosh_w_moments>;
+using tanh_w_moments_tag = function_tag<&tanh_w_moments>;
+using fmod_w_moments_tag = function_tag<&fmod_w_moments>;
+using atan2_w_moments_tag = function_tag<&atan2_w_moments>;
+using pow_w_moments_tag = function_tag<&pow_w_moments>;
+
+// Tags for the plain double math functions, for per-sample use by
+// UDoubleEnsemble::func1()/func2().  The standard library overloads these
+// names, so they are wrapped rather than passed by address.
+#define UNCERTAIN_MATH_TAG1(name)                                                                  \
+  struct name##_tag {                                                                              \
+    double operator()(double a) const { return std::name(a); }                                     \
+  };
+#define UNCERTAIN_MATH_TAG2(name)                                                                  \
+  struct name##_tag {                                                                              \
+    double operator()(double a, double b) const { return std::name(a, b); }                        \
+  };
+UNCERTAIN_MATH_TAG1(sqrt)
+UNCERTAIN_MATH_TAG1(sin)
+UNCERTAIN_MATH_TAG1(cos)
+UNCERTAIN_MATH_TAG1(tan)
+UNCERTAIN_MATH_TAG1(asin)
+UNCERTAIN_MATH_TAG1(acos)
+UNCERTAIN_MATH_TAG1(atan)
+UNCERTAIN_MATH_TAG1(ceil)
+UNCERTAIN_MATH_TAG1(floor)
+UNCERTAIN_MATH_TAG1(fabs)
+UNCERTAIN_MATH_TAG1(exp)
+UNCERTAIN_MATH_TAG1(log)
+UNCERTAIN_MATH_TAG1(log10)
+UNCERTAIN_MATH_TAG1(sinh)
+UNCERTAIN_MATH_TAG1(cosh)
+UNCERTAIN_MATH_TAG1(tanh)
+UNCERTAIN_MATH_TAG2(fmod)
+UNCERTAIN_MATH_TAG2(atan2)
+UNCERTAIN_MATH_TAG2(pow)
+#undef UNCERTAIN_MATH_TAG1
+#undef UNCERTAIN_MATH_TAG2
+
+// Whether gauss_loss() would warn; lets callers skip building the
+// message text when it would not be printed.
+inline bool near_discontinuity(double uncertainty, double disc_dist,
+                               const discontinuity_type &disc_type, double disc_thresh) {
+  return (disc_type != discontinuity_type::none) &&
+         (std::fabs(disc_dist / uncertainty) < disc_thresh);
+}
+
+// The quantile of the standard normal distribution at probability p, to
+// about 1e-16 relative (AS241; see vec_inverse_normal_cdf() in kernels.hpp
+// for whole arrays).
+double inverse_normal_cdf(double p);
+
+// This function returns the inverse Gaussian density function: the x with
+// a probability p of a standard normal deviate above it, for 0 < p <= 0.5.
 inline double inverse_gaussian_density(double p) {
   if (p <= 0.0) {
     throw std::runtime_error("inverse_gaussian_density() called for negative value: " +
@@ -459,12 +536,7 @@ inline double inverse_gaussian_density(double p) {
     throw std::runtime_error("inverse_gaussian_density() called for too large value: " +
                              std::to_string(p));
   }
-
-  const double c0 = 2.515517, c1 = 0.802853, c2 = 0.010328;
-  const double d1 = 1.432788, d2 = 0.189269, d3 = 0.001308;
-  double t = std::sqrt(std::log(1.0 / (p * p)));
-
-  return t - (c0 + t * (c1 + c2 * t)) / (1.0 + t * (d1 + t * (d2 + t * d3)));
+  return -inverse_normal_cdf(p);
 }
 
 // Compare function to sort by absolute value
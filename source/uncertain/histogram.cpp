@@ -0,0 +1,118 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// histogram.cpp: This file includes histograms and quantiles of the samples
+// of the ensemble classes.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <uncertain/histogram.hpp>
+#include <uncertain/kernels.hpp>
+
+namespace uncertain {
+
+Histogram::Histogram(double low, double high, size_t bins) : low_(low), high_(high) {
+  if (!(low < high) || !std::isfinite(high - low))
+    throw std::runtime_error("Histogram needs finite limits, low < high");
+  if (bins == 0 || bins >= size_t(INT32_MAX) - 1)
+    throw std::runtime_error("Histogram cannot have " + std::to_string(bins) + " bins");
+  counts_.assign(bins + 2, 0);
+}
+
+void Histogram::add(const double *samples, size_t n) {
+  vec_histogram(samples, n, low_, bins() / (high_ - low_), bins(), counts_.data());
+}
+
+void Histogram::merge(const Histogram &other) {
+  if (other.low_ != low_ || other.high_ != high_ || other.counts_.size() != counts_.size())
+    throw std::runtime_error("Cannot merge histograms with different bins");
+  for (size_t i = 0; i < counts_.size(); i++) counts_[i] += other.counts_[i];
+}
+
+size_t Histogram::total() const {
+  return std::accumulate(counts_.begin(), counts_.end(), size_t(0));
+}
+
+double Histogram::quantile(double p) const {
+  size_t n = total();
+  if (n == 0 || !(p >= 0.0 && p <= 1.0)) return std::numeric_limits<double>::quiet_NaN();
+  double target = p * n;
+  double cumulative = below();
+  if (cumulative > 0 && target <= cumulative) return low_;
+  for (size_t bin = 0; bin < bins(); bin++) {
+    double count = this->count(bin);
+    if (count > 0 && target <= cumulative + count)
+      return bin_low(bin) + (target - cumulative) / count * bin_width();
+    cumulative += count;
+  }
+  return high_;
+}
+
+std::vector<double> sample_quantiles(double *samples, size_t n,
+                                     const std::vector<double> &probabilities) {
+  std::vector<double> retval(probabilities.size(), std::numeric_limits<double>::quiet_NaN());
+  for (double p : probabilities)
+    if (!(p >= 0.0 && p <= 1.0))
+      throw std::runtime_error("sample_quantiles() called for probability " + std::to_string(p));
+  if (n == 0) return retval;
+
+  // Taking the probabilities in increasing order, each selection only
+  // needs to partition the samples above the previous one.
+  std::vector<size_t> order(probabilities.size());
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return probabilities[a] < probabilities[b]; });
+  size_t begin = 0;
+  for (size_t i : order) {
+    double h = (n - 1) * probabilities[i];
+    size_t k = std::min(size_t(h), n - 1);
+    std::nth_element(samples + begin, samples + k, samples + n);
+    begin = k;
+    double value = samples[k];
+    double fraction = h - k;
+    if (fraction > 0.0 && k + 1 < n) {
+      // the next order statistic is the least of those above
+      double *next = std::min_element(samples + k + 1, samples + n);
+      std::iter_swap(samples + k + 1, next);
+      value += fraction * (samples[k + 1] - value);
+    }
+    retval[i] = value;
+  }
+  return retval;
+}
+
+}  // namespace uncertain
@@ -0,0 +1,87 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// histogram.hpp: This file includes histograms and quantiles of the samples
+// of the ensemble classes.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace uncertain {
+
+// Counts of samples in bins of equal width between low and high.  The
+// samples below low (and NaNs) and those at or above high are counted
+// apart.  Histograms with the same bins can be merged, e.g. to superimpose
+// several ensembles or to combine ones filled on several threads.
+class Histogram {
+ public:
+  Histogram(double low, double high, size_t bins);
+
+  // counts n more samples
+  void add(const double *samples, size_t n);
+
+  // adds the counts of another histogram with the same bins
+  void merge(const Histogram &other);
+
+  double low() const { return low_; }
+  double high() const { return high_; }
+  size_t bins() const { return counts_.size() - 2; }
+  double bin_width() const { return (high_ - low_) / bins(); }
+  double bin_low(size_t bin) const { return low_ + bin * bin_width(); }
+  double bin_center(size_t bin) const { return low_ + (bin + 0.5) * bin_width(); }
+
+  size_t count(size_t bin) const { return counts_[bin + 1]; }
+  size_t below() const { return counts_.front(); }
+  size_t above() const { return counts_.back(); }
+  size_t total() const;
+
+  // The p quantile, interpolated within its bin, so to within a bin width
+  // for the samples in range.  Below low or above high it is the limit;
+  // NaN when empty.
+  double quantile(double p) const;
+
+ private:
+  double low_;
+  double high_;
+  std::vector<size_t> counts_;  // below, the bins, above
+};
+
+// The exact p quantiles of the samples, for each p of probabilities,
+// interpolated linearly between the order statistics (as R's type 7 and
+// numpy's default).  Reorders the samples; O(n) for each quantile asked.
+// Throws for probabilities outside [0, 1]; NaNs when there are no samples.
+std::vector<double> sample_quantiles(double *samples, size_t n,
+                                     const std::vector<double> &probabilities);
+
+}  // namespace uncertain
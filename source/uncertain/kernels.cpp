@@ -0,0 +1,560 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// kernels.cpp: This file includes element-wise kernels over arrays of
+// doubles, used by the ensemble classes for their arithmetic and math
+// functions.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <uncertain/kernels.hpp>
+#include <uncertain/vector_math.hpp>
+
+namespace uncertain {
+
+namespace {
+
+// Independent partial sums, each with its own compensation term.  The
+// lanes break the dependency between consecutive additions, so the loops
+// over them vectorize.
+constexpr size_t kSumLanes = 8;
+
+struct NeumaierLanes {
+  double sum[kSumLanes] = {};
+  double comp[kSumLanes] = {};
+
+  void add(size_t lane, double x) {
+    double s = sum[lane], t = s + x;
+    comp[lane] += (std::fabs(s) >= std::fabs(x)) ? (s - t) + x : (x - t) + s;
+    sum[lane] = t;
+  }
+
+  double total() const {
+    NeumaierLanes last;
+    for (size_t j = 0; j < kSumLanes; j++) {
+      last.add(0, sum[j]);
+      last.add(0, comp[j]);
+    }
+    return last.sum[0] + last.comp[0];
+  }
+};
+
+template <size_t order>
+inline void power_sums(const double *a, size_t n, double center, double *sums) {
+  NeumaierLanes lanes[order];
+  size_t i = 0;
+  for (; i + kSumLanes <= n; i += kSumLanes)
+    for (size_t j = 0; j < kSumLanes; j++) {
+      double diff = a[i + j] - center, power = diff;
+      for (size_t k = 0; k < order; k++) {
+        lanes[k].add(j, power);
+        power *= diff;
+      }
+    }
+  for (size_t j = 0; i < n; i++, j++) {
+    double diff = a[i] - center, power = diff;
+    for (size_t k = 0; k < order; k++) {
+      lanes[k].add(j, power);
+      power *= diff;
+    }
+  }
+  for (size_t k = 0; k < order; k++) sums[k] = lanes[k].total();
+}
+
+// Running moment sums, one set per lane.
+template <size_t order>
+struct MomentLanes {
+  double count[kSumLanes] = {};
+  double mean[kSumLanes] = {};
+  double m2[kSumLanes] = {};
+  double m3[kSumLanes] = {};
+  double m4[kSumLanes] = {};
+  double m5[kSumLanes] = {};
+
+  // Pebay's update for one more sample; written with the old count n_a
+  // as a factor instead of a divisor so the first sample needs no branch.
+  void add(size_t lane, double x) {
+    double n_a = count[lane], r = 1.0 / (n_a + 1.0);
+    double d = x - mean[lane], dr = d * r, b = -dr;
+    if (order >= 5)
+      m5[lane] += (5.0 * m4[lane] + (10.0 * m3[lane] + 10.0 * m2[lane] * b) * b) * b +
+                  dr * dr * dr * dr * dr * n_a * (n_a * n_a * n_a * n_a - 1.0);
+    if (order >= 4)
+      m4[lane] += (4.0 * m3[lane] + 6.0 * m2[lane] * b) * b +
+                  dr * dr * dr * dr * n_a * (n_a * n_a * n_a + 1.0);
+    if (order >= 3)
+      m3[lane] += 3.0 * m2[lane] * b + dr * dr * dr * n_a * (n_a * n_a - 1.0);
+    if (order >= 2) m2[lane] += d * dr * n_a;
+    mean[lane] += dr;
+    count[lane] = n_a + 1.0;
+  }
+
+  MomentSums lane(size_t j) const {
+    MomentSums retval;
+    retval.count = count[j];
+    retval.mean = mean[j];
+    retval.m2 = m2[j];
+    retval.m3 = m3[j];
+    retval.m4 = m4[j];
+    retval.m5 = m5[j];
+    return retval;
+  }
+};
+
+// Pebay's formula for the sums of the union of two disjoint sets.
+template <size_t order>
+inline void merge_moments(MomentSums &a, const MomentSums &b) {
+  if (b.count == 0.0) return;
+  if (a.count == 0.0) {
+    a = b;
+    return;
+  }
+  double n = a.count + b.count, d = b.mean - a.mean;
+  double ba = -b.count / n * d, bb = a.count / n * d, q = a.count * b.count / n * d;
+  double ia = 1.0 / a.count, ib = 1.0 / b.count;
+  MomentSums retval;
+  retval.count = n;
+  retval.mean = a.mean + b.count / n * d;
+  if (order >= 2) retval.m2 = a.m2 + b.m2 + q * q * (ib + ia);
+  if (order >= 3)
+    retval.m3 = a.m3 + b.m3 + 3.0 * (a.m2 * ba + b.m2 * bb) + q * q * q * (ib * ib - ia * ia);
+  if (order >= 4)
+    retval.m4 = a.m4 + b.m4 + 4.0 * (a.m3 * ba + b.m3 * bb) +
+                6.0 * (a.m2 * ba * ba + b.m2 * bb * bb) +
+                q * q * q * q * (ib * ib * ib + ia * ia * ia);
+  if (order >= 5)
+    retval.m5 = a.m5 + b.m5 + 5.0 * (a.m4 * ba + b.m4 * bb) +
+                10.0 * (a.m3 * ba * ba + b.m3 * bb * bb) +
+                10.0 * (a.m2 * ba * ba * ba + b.m2 * bb * bb * bb) +
+                q * q * q * q * q * (ib * ib * ib * ib - ia * ia * ia * ia);
+  a = retval;
+}
+
+// The samples are taken relative to the first one, so the running means
+// stay small next to a large common offset and keep their precision.
+template <size_t order>
+inline MomentSums moment_sums(const double *a, size_t n) {
+  MomentLanes<order> lanes;
+  double pivot = n ? a[0] : 0.0;
+  size_t i = 0;
+  for (; i + kSumLanes <= n; i += kSumLanes)
+    for (size_t j = 0; j < kSumLanes; j++) lanes.add(j, a[i + j] - pivot);
+  for (size_t j = 0; i < n; i++, j++) lanes.add(j, a[i] - pivot);
+  MomentSums retval;
+  for (size_t j = 0; j < kSumLanes; j++) merge_moments<order>(retval, lanes.lane(j));
+  retval.mean += pivot;
+  return retval;
+}
+
+// Running co-moment sums, one set per lane.
+struct CoMomentLanes {
+  double count[kSumLanes] = {};
+  double mean_a[kSumLanes] = {};
+  double mean_b[kSumLanes] = {};
+  double m2_a[kSumLanes] = {};
+  double m2_b[kSumLanes] = {};
+  double c[kSumLanes] = {};
+
+  void add(size_t lane, double x, double y) {
+    double n = count[lane] + 1.0;
+    double dx = x - mean_a[lane], dy = y - mean_b[lane];
+    mean_a[lane] += dx / n;
+    mean_b[lane] += dy / n;
+    double dy_new = y - mean_b[lane];
+    m2_a[lane] += dx * (x - mean_a[lane]);
+    m2_b[lane] += dy * dy_new;
+    c[lane] += dx * dy_new;
+    count[lane] = n;
+  }
+
+  CoMomentSums lane(size_t j) const {
+    CoMomentSums retval;
+    retval.count = count[j];
+    retval.mean_a = mean_a[j];
+    retval.mean_b = mean_b[j];
+    retval.m2_a = m2_a[j];
+    retval.m2_b = m2_b[j];
+    retval.c = c[j];
+    return retval;
+  }
+};
+
+// c[0] + c[1] x + c[2] x^2 + ... by Horner's rule
+template <size_t N>
+inline double polynomial(const double (&c)[N], double x) {
+  double y = c[N - 1];
+  for (size_t i = N - 1; i-- > 0;) y = y * x + c[i];
+  return y;
+}
+
+// The coefficients of AS241 (PPND16), Wichura, Applied Statistics 37
+// (1988) 477-484: rational approximations for |p - 0.5| <= 0.425, and in
+// the tails in r = sqrt(-log(min(p, 1 - p))) for r <= 5 and beyond.
+constexpr double kCentralNum[8] = {
+    3.3871328727963666080e+0, 1.3314166789178437745e+2, 1.9715909503065514427e+3,
+    1.3731693765509461125e+4, 4.5921953931549871457e+4, 6.7265770927008700853e+4,
+    3.3430575583588128105e+4, 2.5090809287301226727e+3};
+constexpr double kCentralDen[8] = {
+    1.0, 4.2313330701600911252e+1, 6.8718700749205790830e+2,
+    5.3941960214247511077e+3, 2.1213794301586595867e+4, 3.9307895800092710610e+4,
+    2.8729085735721942674e+4, 5.2264952788528545610e+3};
+constexpr double kNearNum[8] = {
+    1.42343711074968357734e+0, 4.63033784615654529590e+0, 5.76949722146069140550e+0,
+    3.64784832476320460504e+0, 1.27045825245236838258e+0, 2.41780725177450611770e-1,
+    2.27238449892691845833e-2, 7.74545014278341407640e-4};
+constexpr double kNearDen[8] = {
+    1.0, 2.05319162663775882187e+0, 1.67638483018380384940e+0,
+    6.89767334985100004550e-1, 1.48103976427480074590e-1, 1.51986665636164571966e-2,
+    5.47593808499534494600e-4, 1.05075007164441684324e-9};
+constexpr double kFarNum[8] = {
+    6.65790464350110377720e+0, 5.46378491116411436990e+0, 1.78482653991729133580e+0,
+    2.96560571828504891230e-1, 2.65321895265761230930e-2, 1.24266094738807843860e-3,
+    2.71155556874348757815e-5, 2.01033439929228813265e-7};
+constexpr double kFarDen[8] = {
+    1.0, 5.99832206555887937690e-1, 1.36929880922735805310e-1,
+    1.48753612908506148525e-2, 7.86869131145613259100e-4, 1.84631831751005468180e-5,
+    1.42151175831644588870e-7, 2.04426310338993978564e-15};
+
+// The quantile of the standard normal distribution for |p - 0.5| <= 0.425,
+// by arithmetic alone.
+inline double ppnd16_central(double p) {
+  double q = p - 0.5;
+  double r = 0.180625 - q * q;
+  return q * polynomial(kCentralNum, r) / polynomial(kCentralDen, r);
+}
+
+// The quantile in the tails, with the limits at 0 and 1 and NaN for the
+// probabilities out of range.
+inline double ppnd16_tail(double p) {
+  if (!(p > 0.0 && p < 1.0)) return p == 0.0 ? -HUGE_VAL : p == 1.0 ? HUGE_VAL : NAN;
+  double r = std::sqrt(-std::log(p < 0.5 ? p : 1.0 - p));
+  double x = r <= 5.0 ? polynomial(kNearNum, r - 1.6) / polynomial(kNearDen, r - 1.6)
+                      : polynomial(kFarNum, r - 5.0) / polynomial(kFarDen, r - 5.0);
+  return p < 0.5 ? -x : x;
+}
+
+// the projection sums of R rows at once, in lanes as for the sums above
+template <size_t R>
+inline void projection_block(const double *d, const double *const *rows, size_t n,
+                             ProjectionSums *sums) {
+  double sum[R][kSumLanes] = {}, square[R][kSumLanes] = {}, cross[R][kSumLanes] = {};
+  double pivot[R];
+  for (size_t r = 0; r < R; r++) pivot[r] = rows[r][0];
+  size_t i = 0;
+  for (; i + kSumLanes <= n; i += kSumLanes)
+    for (size_t r = 0; r < R; r++)
+      for (size_t j = 0; j < kSumLanes; j++) {
+        double t = rows[r][i + j] - pivot[r];
+        sum[r][j] += t;
+        square[r][j] += t * t;
+        cross[r][j] += d[i + j] * t;
+      }
+  for (size_t j = 0; i < n; i++, j++)
+    for (size_t r = 0; r < R; r++) {
+      double t = rows[r][i] - pivot[r];
+      sum[r][j] += t;
+      square[r][j] += t * t;
+      cross[r][j] += d[i] * t;
+    }
+  for (size_t r = 0; r < R; r++) {
+    sums[r] = ProjectionSums();
+    for (size_t j = 0; j < kSumLanes; j++) {
+      sums[r].sum += sum[r][j];
+      sums[r].square += square[r][j];
+      sums[r].cross += cross[r][j];
+    }
+  }
+}
+
+constexpr size_t kProjectionRows = 4;
+
+}  // namespace
+
+void MomentSums::merge(const MomentSums &other) { merge_moments<5>(*this, other); }
+
+void CoMomentSums::merge(const CoMomentSums &other) {
+  if (other.count == 0.0) return;
+  if (count == 0.0) {
+    *this = other;
+    return;
+  }
+  double n = count + other.count, weight = count * other.count / n;
+  double da = other.mean_a - mean_a, db = other.mean_b - mean_b;
+  m2_a += other.m2_a + da * da * weight;
+  m2_b += other.m2_b + db * db * weight;
+  c += other.c + da * db * weight;
+  mean_a += da * other.count / n;
+  mean_b += db * other.count / n;
+  count = n;
+}
+
+UNCERTAIN_TARGET_CLONES void vec_add(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] += b[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_sub(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] -= b[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_mul(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] *= b[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_div(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] /= b[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_add(double *a, double b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] += b;
+}
+
+UNCERTAIN_TARGET_CLONES void vec_sub(double *a, double b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] -= b;
+}
+
+UNCERTAIN_TARGET_CLONES void vec_mul(double *a, double b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] *= b;
+}
+
+UNCERTAIN_TARGET_CLONES void vec_div(double *a, double b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] /= b;
+}
+
+UNCERTAIN_TARGET_CLONES void vec_rsub(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = b[i] - a[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_rdiv(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = b[i] / a[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_rsub(double *a, double b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = b - a[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_rdiv(double *a, double b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = b / a[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_negate(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = -a[i];
+}
+
+UNCERTAIN_TARGET_CLONES void vec_sqrt(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::sqrt(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_sin(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::sin(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_cos(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::cos(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_tan(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::tan(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_asin(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::asin(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_acos(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::acos(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_atan(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::atan(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_ceil(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::ceil(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_floor(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::floor(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_fabs(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::fabs(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_exp(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::exp(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_log(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::log(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_log10(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::log10(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_sinh(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::sinh(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_cosh(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::cosh(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_tanh(double *a, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::tanh(a[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_inverse_normal_cdf(double *a, size_t n) {
+  // The central region, 85% of the probability, is pure arithmetic and
+  // vectorizes; the tails need a log and a square root and are taken one
+  // at a time, in blocks so the central values stay in the cache.
+  constexpr size_t kBlock = 64;
+  double central[kBlock];
+  for (size_t start = 0; start < n; start += kBlock) {
+    size_t m = std::min(kBlock, n - start);
+    double *p = a + start;
+    for (size_t i = 0; i < m; i++) central[i] = ppnd16_central(p[i]);
+    for (size_t i = 0; i < m; i++)
+      p[i] = std::fabs(p[i] - 0.5) <= 0.425 ? central[i] : ppnd16_tail(p[i]);
+  }
+}
+
+UNCERTAIN_TARGET_CLONES void vec_fmod(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::fmod(a[i], b[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_atan2(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::atan2(a[i], b[i]);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_pow(double *a, const double *b, size_t n) {
+  for (size_t i = 0; i < n; i++) a[i] = std::pow(a[i], b[i]);
+}
+
+UNCERTAIN_TARGET_CLONES double vec_sum(const double *a, size_t n) {
+  NeumaierLanes lanes;
+  size_t i = 0;
+  for (; i + kSumLanes <= n; i += kSumLanes)
+    for (size_t j = 0; j < kSumLanes; j++) lanes.add(j, a[i + j]);
+  for (size_t j = 0; i < n; i++, j++) lanes.add(j, a[i]);
+  return lanes.total();
+}
+
+UNCERTAIN_TARGET_CLONES void vec_power_sums(const double *a, size_t n, double center,
+                                            size_t order, double *sums) {
+  switch (order) {
+    case 0:
+      return;
+    case 1:
+      return power_sums<1>(a, n, center, sums);
+    case 2:
+      return power_sums<2>(a, n, center, sums);
+    case 3:
+      return power_sums<3>(a, n, center, sums);
+    case 4:
+      return power_sums<4>(a, n, center, sums);
+    case 5:
+      return power_sums<5>(a, n, center, sums);
+    default:
+      throw std::runtime_error("vec_power_sums: order " + std::to_string(order) + " above 5");
+  }
+}
+
+UNCERTAIN_TARGET_CLONES MomentSums vec_moment_sums(const double *a, size_t n, size_t order) {
+  switch (order) {
+    case 0:
+    case 1:
+      return moment_sums<1>(a, n);
+    case 2:
+      return moment_sums<2>(a, n);
+    case 3:
+      return moment_sums<3>(a, n);
+    case 4:
+      return moment_sums<4>(a, n);
+    case 5:
+      return moment_sums<5>(a, n);
+    default:
+      throw std::runtime_error("vec_moment_sums: order " + std::to_string(order) + " above 5");
+  }
+}
+
+UNCERTAIN_TARGET_CLONES CoMomentSums vec_comoment_sums(const double *a, const double *b,
+                                                       size_t n) {
+  CoMomentLanes lanes;
+  double pivot_a = n ? a[0] : 0.0, pivot_b = n ? b[0] : 0.0;
+  size_t i = 0;
+  for (; i + kSumLanes <= n; i += kSumLanes)
+    for (size_t j = 0; j < kSumLanes; j++) lanes.add(j, a[i + j] - pivot_a, b[i + j] - pivot_b);
+  for (size_t j = 0; i < n; i++, j++) lanes.add(j, a[i] - pivot_a, b[i] - pivot_b);
+  CoMomentSums retval;
+  for (size_t j = 0; j < kSumLanes; j++) retval.merge(lanes.lane(j));
+  retval.mean_a += pivot_a;
+  retval.mean_b += pivot_b;
+  return retval;
+}
+
+UNCERTAIN_TARGET_CLONES void vec_projection_sums(const double *d, const double *const *rows,
+                                                 size_t num_rows, size_t n, ProjectionSums *sums) {
+  if (n == 0) {
+    for (size_t r = 0; r < num_rows; r++) sums[r] = ProjectionSums();
+    return;
+  }
+  size_t r = 0;
+  for (; r + kProjectionRows <= num_rows; r += kProjectionRows)
+    projection_block<kProjectionRows>(d, rows + r, n, sums + r);
+  for (; r < num_rows; r++) projection_block<1>(d, rows + r, n, sums + r);
+}
+
+UNCERTAIN_TARGET_CLONES void vec_histogram(const double *a, size_t n, double low, double scale,
+                                           size_t bins, size_t *counts) {
+  // The counter of each sample in a block is found with selects instead of
+  // branches, so it vectorizes; only the increments are one at a time.
+  constexpr size_t kBlock = 256;
+  int32_t index[kBlock];
+  const double top = double(bins) + 1.0;
+  for (size_t start = 0; start < n; start += kBlock) {
+    size_t m = std::min(kBlock, n - start);
+    const double *x = a + start;
+    for (size_t i = 0; i < m; i++) {
+      double t = (x[i] - low) * scale;
+      t = t >= 0.0 ? t + 1.0 : 0.0;
+      t = t < top ? t : top;
+      index[i] = static_cast<int32_t>(t);
+    }
+    for (size_t i = 0; i < m; i++) counts[index[i]]++;
+  }
+}
+
+}  // namespace uncertain
@@ -0,0 +1,172 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// kernels.hpp: This file includes element-wise kernels over arrays of
+// doubles, used by the ensemble classes for their arithmetic and math
+// functions.
+
+#pragma once
+
+#include <cstddef>
+
+namespace uncertain {
+
+// Each kernel is compiled for several instruction sets (SSE2, AVX2 and
+// AVX-512 on x86-64) and the version for the running CPU is selected when
+// the library is loaded.  Where the C library provides vector versions of
+// the math functions (glibc's libmvec) the math kernels call them, so each
+// instruction evaluates several elements.
+
+// a[i] op= b[i]
+void vec_add(double *a, const double *b, size_t n);
+void vec_sub(double *a, const double *b, size_t n);
+void vec_mul(double *a, const double *b, size_t n);
+void vec_div(double *a, const double *b, size_t n);
+
+// a[i] op= b
+void vec_add(double *a, double b, size_t n);
+void vec_sub(double *a, double b, size_t n);
+void vec_mul(double *a, double b, size_t n);
+void vec_div(double *a, double b, size_t n);
+
+// a[i] = b[i] op a[i], for reusing the storage of a right-hand operand
+void vec_rsub(double *a, const double *b, size_t n);
+void vec_rdiv(double *a, const double *b, size_t n);
+
+// a[i] = b op a[i]
+void vec_rsub(double *a, double b, size_t n);
+void vec_rdiv(double *a, double b, size_t n);
+
+// a[i] = -a[i]
+void vec_negate(double *a, size_t n);
+
+// a[i] = f(a[i])
+void vec_sqrt(double *a, size_t n);
+void vec_sin(double *a, size_t n);
+void vec_cos(double *a, size_t n);
+void vec_tan(double *a, size_t n);
+void vec_asin(double *a, size_t n);
+void vec_acos(double *a, size_t n);
+void vec_atan(double *a, size_t n);
+void vec_ceil(double *a, size_t n);
+void vec_floor(double *a, size_t n);
+void vec_fabs(double *a, size_t n);
+void vec_exp(double *a, size_t n);
+void vec_log(double *a, size_t n);
+void vec_log10(double *a, size_t n);
+void vec_sinh(double *a, size_t n);
+void vec_cosh(double *a, size_t n);
+void vec_tanh(double *a, size_t n);
+
+// a[i] = the quantile of the standard normal distribution at probability
+// a[i], by Wichura's algorithm AS241 (relative error about 1e-16); -inf
+// and inf at 0 and 1 and NaN outside [0, 1].
+void vec_inverse_normal_cdf(double *a, size_t n);
+
+// a[i] = f(a[i], b[i])
+void vec_fmod(double *a, const double *b, size_t n);
+void vec_atan2(double *a, const double *b, size_t n);
+void vec_pow(double *a, const double *b, size_t n);
+
+// Reductions for the statistics of ensembles.  They use compensated
+// (Neumaier) summation in several independent lanes, so the result is
+// about as accurate as the sum of the exactly rounded terms regardless
+// of n and of the order of the terms, in one pass without scratch memory.
+
+// sum of a[i]
+double vec_sum(const double *a, size_t n);
+
+// sums[k - 1] = sum of (a[i] - center)^k for k = 1 .. order, order <= 5
+void vec_power_sums(const double *a, size_t n, double center, size_t order, double *sums);
+
+// The count, mean and sums of the powers of the differences from the
+// mean of an array, mk = sum of (a[i] - mean)^k.  Sums above the order
+// asked for are left zero.
+struct MomentSums {
+  double count = 0.0;
+  double mean = 0.0;
+  double m2 = 0.0;
+  double m3 = 0.0;
+  double m4 = 0.0;
+  double m5 = 0.0;
+
+  // adds the sums over another, disjoint set of samples, to order 5; to
+  // the precision of the difference of the means
+  void merge(const MomentSums &other);
+};
+
+// The means of two arrays and the sums of the squares and of the products
+// of their differences from the means.
+struct CoMomentSums {
+  double count = 0.0;
+  double mean_a = 0.0;
+  double mean_b = 0.0;
+  double m2_a = 0.0;  // sum of (a[i] - mean_a)^2
+  double m2_b = 0.0;  // sum of (b[i] - mean_b)^2
+  double c = 0.0;     // sum of (a[i] - mean_a) * (b[i] - mean_b)
+
+  // adds the sums over another, disjoint set of pairs
+  void merge(const CoMomentSums &other);
+};
+
+// These compute all the sums in a single pass.  Each lane keeps running
+// sums of the samples relative to the first one, updated one sample at a
+// time (Welford's method extended to higher orders by Pebay), and the
+// lanes are merged at the end.
+
+// the sums of orders 2 .. order of a[i], order <= 5
+MomentSums vec_moment_sums(const double *a, size_t n, size_t order = 5);
+
+// the co-moments of pairs (a[i], b[i])
+CoMomentSums vec_comoment_sums(const double *a, const double *b, size_t n);
+
+// The sums of an array s relative to its first sample, of their squares,
+// and of their products with another array d.
+struct ProjectionSums {
+  double sum = 0.0;     // sum of (s[i] - s[0])
+  double square = 0.0;  // sum of (s[i] - s[0])^2
+  double cross = 0.0;   // sum of d[i] * (s[i] - s[0])
+};
+
+// sums[r] = the projection sums of rows[r] on d, for num_rows arrays of n
+// samples each.  Several rows are taken together, so d is read once for
+// all of them: a matrix-vector product with the centering folded in.
+void vec_projection_sums(const double *d, const double *const *rows, size_t num_rows, size_t n,
+                         ProjectionSums *sums);
+
+// counts[k + 1] += the number of a[i] in [low + k / scale, low + (k + 1) / scale)
+// for k < bins, counts[0] += those below low or NaN and counts[bins + 1] +=
+// those above, so counts has bins + 2 entries; bins < 2^31 - 1.
+void vec_histogram(const double *a, size_t n, double low, double scale, size_t bins,
+                   size_t *counts);
+
+}  // namespace uncertain
@@ -0,0 +1,93 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// make_basis_table.cpp: This file includes the build step that writes the
+// Gaussian basis of the ensemble classes for a list of sizes into a source
+// file of the library, so that no process has to build them at startup.
+//
+// usage: make_basis_table <output.cpp> [size...]
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <uncertain/ensemble_basis.hpp>
+#include <vector>
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <output.cpp> [size...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<size_t> sizes;
+  for (int i = 2; i < argc; i++) {
+    char *end = nullptr;
+    unsigned long long size = std::strtoull(argv[i], &end, 10);
+    if (*end != '\0' || size < 2) {
+      std::cerr << "invalid ensemble size: " << argv[i] << std::endl;
+      return EXIT_FAILURE;
+    }
+    sizes.push_back(size);
+  }
+
+  std::ofstream out(argv[1]);
+  out << "// Generated by make_basis_table from ensemble_basis.cpp; do not edit.\n\n"
+      << "#include <uncertain/ensemble_basis.hpp>\n\n"
+      << "namespace uncertain {\n\n";
+  if (!sizes.empty()) out << "namespace {\n\n";
+  // hexadecimal floating point literals keep every bit of the samples
+  out << std::hexfloat;
+  for (size_t size : sizes) {
+    std::vector<double> basis = uncertain::compute_gauss_basis(size);
+    out << "const double basis_" << size << "[" << size << "] = {\n";
+    for (double value : basis) out << "    " << value << ",\n";
+    out << "};\n\n";
+  }
+  if (!sizes.empty()) out << "}  // namespace\n\n";
+
+  out << "const double *precomputed_gauss_basis(size_t n) {\n"
+      << "  switch (n) {\n";
+  for (size_t size : sizes) out << "    case " << size << ":\n      return basis_" << size << ";\n";
+  out << "    default:\n"
+      << "      return nullptr;\n"
+      << "  }\n"
+      << "}\n\n"
+      << "}  // namespace uncertain\n";
+
+  out.close();
+  if (!out) {
+    std::cerr << "could not write " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ms_batch.cpp: This file includes the batch kernels of UDoubleMSBatch<>.
+
+#include <uncertain/ms_batch.hpp>
+#include <uncertain/vector_math.hpp>
+
+namespace uncertain {
+
+namespace {
+
+template <bool is_correlated, class Op>
+inline void apply1(double *v, double *u, size_t n, Op op) {
+  for (size_t i = 0; i < n; i++)
+    MSBatchAccess::store(op(MSBatchAccess::load<is_correlated>(v, u, i)), v, u, i);
+}
+
+template <bool is_correlated, class Op>
+inline void apply2(double *v, double *u, const double *yv, const double *yu, size_t n, Op op) {
+  for (size_t i = 0; i < n; i++)
+    MSBatchAccess::store(op(MSBatchAccess::load<is_correlated>(v, u, i),
+                            MSBatchAccess::load<is_correlated>(yv, yu, i)),
+                         v, u, i);
+}
+
+// sqrt(a * a + b * b) like std::hypot, without overflow or underflow of the
+// squares, as arithmetic and selects that vectorize.  It can differ from
+// std::hypot in the last bit.
+inline double batch_hypot(double a, double b) {
+  a = std::fabs(a);
+  b = std::fabs(b);
+  const double big = (a < b) ? b : a, small = (a < b) ? a : b;
+  const double r = small / big;
+  const double h = (big == 0.0) ? 0.0 : big * std::sqrt(1.0 + r * r);
+  // an infinite argument wins over a NaN, as in std::hypot
+  return ((a == HUGE_VAL) || (b == HUGE_VAL)) ? HUGE_VAL : h;
+}
+
+// The arithmetic of UDoubleMS between two batches, as loops over the
+// arrays, with batch_hypot() in place of std::hypot for uncorrelated
+// uncertainties.  Returns false for the other operations.  It has clones
+// of its own, as it is too large to be inlined into those of its callers.
+template <bool is_correlated>
+UNCERTAIN_TARGET_CLONES bool arithmetic2(MSBatchOp2 op, double *v, double *u, const double *yv,
+                                         const double *yu, size_t n) {
+  switch (op) {
+    case MSBatchOp2::add:
+      for (size_t i = 0; i < n; i++) {
+        u[i] = is_correlated ? u[i] + yu[i] : batch_hypot(u[i], yu[i]);
+        v[i] += yv[i];
+      }
+      return true;
+    case MSBatchOp2::sub:
+      for (size_t i = 0; i < n; i++) {
+        u[i] = is_correlated ? u[i] - yu[i] : batch_hypot(u[i], yu[i]);
+        v[i] -= yv[i];
+      }
+      return true;
+    case MSBatchOp2::mul:
+      for (size_t i = 0; i < n; i++) {
+        u[i] = is_correlated ? u[i] * yv[i] + yu[i] * v[i]
+                             : batch_hypot(u[i] * yv[i], yu[i] * v[i]);
+        v[i] *= yv[i];
+      }
+      return true;
+    case MSBatchOp2::div:
+      for (size_t i = 0; i < n; i++) {
+        u[i] = is_correlated ? u[i] / yv[i] - (yu[i] * v[i]) / (yv[i] * yv[i])
+                             : batch_hypot(u[i] / yv[i], (yu[i] * v[i]) / (yv[i] * yv[i]));
+        v[i] /= yv[i];
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+// These call visit with a function object for op.  The switch sits
+// outside the loops, so each loop body is a fixed formula that the
+// compiler can vectorize.  Unqualified calls find the UDoubleMS overloads,
+// with the same conversions of double operands as a loop would use.
+template <class Visit>
+inline void visit_op(MSBatchOp1 op, Visit visit) {
+  switch (op) {
+    case MSBatchOp1::negate:
+      return visit([](const auto &x) { return -x; });
+    case MSBatchOp1::sqrt:
+      return visit([](const auto &x) { return sqrt(x); });
+    case MSBatchOp1::sin:
+      return visit([](const auto &x) { return sin(x); });
+    case MSBatchOp1::cos:
+      return visit([](const auto &x) { return cos(x); });
+    case MSBatchOp1::tan:
+      return visit([](const auto &x) { return tan(x); });
+    case MSBatchOp1::asin:
+      return visit([](const auto &x) { return asin(x); });
+    case MSBatchOp1::acos:
+      return visit([](const auto &x) { return acos(x); });
+    case MSBatchOp1::atan:
+      return visit([](const auto &x) { return atan(x); });
+    case MSBatchOp1::ceil:
+      return visit([](const auto &x) { return ceil(x); });
+    case MSBatchOp1::floor:
+      return visit([](const auto &x) { return floor(x); });
+    case MSBatchOp1::fabs:
+      return visit([](const auto &x) { return fabs(x); });
+    case MSBatchOp1::exp:
+      return visit([](const auto &x) { return exp(x); });
+    case MSBatchOp1::log:
+      return visit([](const auto &x) { return log(x); });
+    case MSBatchOp1::log10:
+      return visit([](const auto &x) { return log10(x); });
+    case MSBatchOp1::sinh:
+      return visit([](const auto &x) { return sinh(x); });
+    case MSBatchOp1::cosh:
+      return visit([](const auto &x) { return cosh(x); });
+    case MSBatchOp1::tanh:
+      return visit([](const auto &x) { return tanh(x); });
+  }
+}
+
+template <class Visit>
+inline void visit_op(MSBatchOp2 op, Visit visit) {
+  switch (op) {
+    case MSBatchOp2::add:
+      return visit([](const auto &x, const auto &y) { return x + y; });
+    case MSBatchOp2::sub:
+      return visit([](const auto &x, const auto &y) { return x - y; });
+    case MSBatchOp2::mul:
+      return visit([](const auto &x, const auto &y) { return x * y; });
+    case MSBatchOp2::div:
+      return visit([](const auto &x, const auto &y) { return x / y; });
+    case MSBatchOp2::fmod:
+      return visit([](const auto &x, const auto &y) { return fmod(x, y); });
+    case MSBatchOp2::atan2:
+      return visit([](const auto &x, const auto &y) { return atan2(x, y); });
+    case MSBatchOp2::pow:
+      return visit([](const auto &x, const auto &y) { return pow(x, y); });
+  }
+}
+
+template <bool is_correlated>
+inline void run(MSBatchOp1 op, double *v, double *u, size_t n) {
+  visit_op(op, [=](auto f) { apply1<is_correlated>(v, u, n, f); });
+}
+
+template <bool is_correlated>
+inline void run(MSBatchOp2 op, double *v, double *u, const double *yv, const double *yu,
+                size_t n) {
+  if (arithmetic2<is_correlated>(op, v, u, yv, yu, n)) return;
+  visit_op(op, [=](auto f) { apply2<is_correlated>(v, u, yv, yu, n, f); });
+}
+
+template <bool is_correlated>
+inline void run(MSBatchOp2 op, double *v, double *u, double y, size_t n) {
+  using UD = UDoubleMS<is_correlated>;
+  visit_op(op, [=](auto f) {
+    apply1<is_correlated>(v, u, n, [=](const UD &x) { return f(x, y); });
+  });
+}
+
+template <bool is_correlated>
+inline void run_reversed(MSBatchOp2 op, double *v, double *u, double y, size_t n) {
+  using UD = UDoubleMS<is_correlated>;
+  visit_op(op, [=](auto f) {
+    apply1<is_correlated>(v, u, n, [=](const UD &x) { return f(y, x); });
+  });
+}
+
+}  // namespace
+
+UNCERTAIN_TARGET_CLONES void ms_batch_apply(MSBatchOp1 op, bool is_correlated, double *v,
+                                            double *u, size_t n) {
+  if (is_correlated)
+    run<true>(op, v, u, n);
+  else
+    run<false>(op, v, u, n);
+}
+
+UNCERTAIN_TARGET_CLONES void ms_batch_apply(MSBatchOp2 op, bool is_correlated, double *v,
+                                            double *u, const double *yv, const double *yu,
+                                            size_t n) {
+  if (is_correlated)
+    run<true>(op, v, u, yv, yu, n);
+  else
+    run<false>(op, v, u, yv, yu, n);
+}
+
+UNCERTAIN_TARGET_CLONES void ms_batch_apply(MSBatchOp2 op, bool is_correlated, double *v,
+                                            double *u, double y, size_t n) {
+  if (is_correlated)
+    run<true>(op, v, u, y, n);
+  else
+    run<false>(op, v, u, y, n);
+}
+
+UNCERTAIN_TARGET_CLONES void ms_batch_apply_reversed(MSBatchOp2 op, bool is_correlated, double *v,
+                                                     double *u, double y, size_t n) {
+  if (is_correlated)
+    run_reversed<true>(op, v, u, y, n);
+  else
+    run_reversed<false>(op, v, u, y, n);
+}
+
+}  // namespace uncertain
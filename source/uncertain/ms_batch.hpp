@@ -0,0 +1,405 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ms_batch.hpp: This file includes a structure-of-arrays container for
+// propagating many independent UDoubleMS values through the same formula.
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <uncertain/double_ms.hpp>
+#include <uncertain/parallel.hpp>
+#include <utility>
+#include <vector>
+
+namespace uncertain {
+
+// Reads and writes the data members of UDoubleMS for the batch code.
+class MSBatchAccess {
+ public:
+  template <bool is_correlated>
+  static UDoubleMS<is_correlated> load(const double *values, const double *uncertainties,
+                                       size_t i) {
+    UDoubleMS<is_correlated> ud;
+    ud.value = values[i];
+    ud.uncertainty = uncertainties[i];
+    return ud;
+  }
+
+  template <bool is_correlated>
+  static void store(const UDoubleMS<is_correlated> &ud, double *values, double *uncertainties,
+                    size_t i) {
+    values[i] = ud.value;
+    uncertainties[i] = ud.uncertainty;
+  }
+};
+
+// Operations with batch kernels in the library.
+enum class MSBatchOp1 {
+  negate,
+  sqrt,
+  sin,
+  cos,
+  tan,
+  asin,
+  acos,
+  atan,
+  ceil,
+  floor,
+  fabs,
+  exp,
+  log,
+  log10,
+  sinh,
+  cosh,
+  tanh
+};
+
+enum class MSBatchOp2 { add, sub, mul, div, fmod, atan2, pow };
+
+// Batch kernels over n values stored as an array of central values (v)
+// and an array of uncertainties (u).  Each element gets what
+// UDoubleMS<is_correlated> computes, except that the math functions may
+// use the vector versions of the C library's functions, and uncorrelated
+// arithmetic a vectorized hypot, both of which can differ in the last
+// bits.
+// x[i] = op(x[i])
+void ms_batch_apply(MSBatchOp1 op, bool is_correlated, double *v, double *u, size_t n);
+// x[i] = op(x[i], y[i])
+void ms_batch_apply(MSBatchOp2 op, bool is_correlated, double *v, double *u, const double *yv,
+                    const double *yu, size_t n);
+// x[i] = op(x[i], y)
+void ms_batch_apply(MSBatchOp2 op, bool is_correlated, double *v, double *u, double y, size_t n);
+// x[i] = op(y, x[i])
+void ms_batch_apply_reversed(MSBatchOp2 op, bool is_correlated, double *v, double *u, double y,
+                             size_t n);
+
+// Batch of independent UDoubleMS values kept as a structure of arrays.
+// Every operation applies to all elements and gives the result of looping
+// over the elements as UDoubleMS<is_correlated> values, up to the last
+// bits as described for the kernels above.  The
+// operators and math functions run vectorized kernels, split across
+// threads with parallel_for() for large batches.  transform() runs a whole
+// formula per element in one pass, which saves memory traffic over a
+// chain of batch operations.
+template <bool is_correlated>
+class UDoubleMSBatch {
+ private:
+  std::vector<double> values;         // the central (expected) values
+  std::vector<double> uncertainties;  // the uncertainties
+
+ public:
+  // Batches shorter than this are not split across threads.
+  static constexpr size_t kMinChunk = 8192;
+
+ private:
+  void check_size(const UDoubleMSBatch &b) const {
+    if (b.size() != size()) {
+      throw std::runtime_error("UDoubleMSBatch size mismatch: " + std::to_string(size()) +
+                               " vs. " + std::to_string(b.size()));
+    }
+  }
+
+  void apply(MSBatchOp1 op) {
+    double *v = values.data(), *u = uncertainties.data();
+    parallel_for(size(), kMinChunk, [=](size_t begin, size_t end) {
+      ms_batch_apply(op, is_correlated, v + begin, u + begin, end - begin);
+    });
+  }
+
+  void apply(MSBatchOp2 op, const UDoubleMSBatch &b) {
+    check_size(b);
+    double *v = values.data(), *u = uncertainties.data();
+    const double *bv = b.values.data(), *bu = b.uncertainties.data();
+    parallel_for(size(), kMinChunk, [=](size_t begin, size_t end) {
+      ms_batch_apply(op, is_correlated, v + begin, u + begin, bv + begin, bu + begin,
+                     end - begin);
+    });
+  }
+
+  void apply(MSBatchOp2 op, double b) {
+    double *v = values.data(), *u = uncertainties.data();
+    parallel_for(size(), kMinChunk, [=](size_t begin, size_t end) {
+      ms_batch_apply(op, is_correlated, v + begin, u + begin, b, end - begin);
+    });
+  }
+
+  void apply_reversed(MSBatchOp2 op, double b) {
+    double *v = values.data(), *u = uncertainties.data();
+    parallel_for(size(), kMinChunk, [=](size_t begin, size_t end) {
+      ms_batch_apply_reversed(op, is_correlated, v + begin, u + begin, b, end - begin);
+    });
+  }
+
+ public:
+  UDoubleMSBatch() = default;
+
+  // n copies of UDoubleMS<is_correlated>(val, unc)
+  explicit UDoubleMSBatch(size_t n, double val = 0.0, double unc = 0.0) {
+    UDoubleMS<is_correlated> ud(val, unc);  // checks the uncertainty
+    values.assign(n, val);
+    uncertainties.assign(n, unc);
+  }
+
+  UDoubleMSBatch(std::vector<double> vals, std::vector<double> uncs)
+      : values(std::move(vals)), uncertainties(std::move(uncs)) {
+    if (values.size() != uncertainties.size()) {
+      throw std::runtime_error("UDoubleMSBatch needs as many uncertainties as values");
+    }
+    if (!is_correlated) {
+      for (double unc : uncertainties)
+        if (unc < 0.0) {
+          throw std::runtime_error("Error: negative uncertainty: " + std::to_string(unc));
+        }
+    }
+  }
+
+  size_t size() const { return values.size(); }
+
+  void reserve(size_t n) {
+    values.reserve(n);
+    uncertainties.reserve(n);
+  }
+
+  void push_back(const UDoubleMS<is_correlated> &ud) {
+    values.emplace_back();
+    uncertainties.emplace_back();
+    MSBatchAccess::store(ud, values.data(), uncertainties.data(), size() - 1);
+  }
+
+  UDoubleMS<is_correlated> operator[](size_t i) const {
+    return MSBatchAccess::load<is_correlated>(values.data(), uncertainties.data(), i);
+  }
+
+  void set(size_t i, const UDoubleMS<is_correlated> &ud) {
+    MSBatchAccess::store(ud, values.data(), uncertainties.data(), i);
+  }
+
+  double mean(size_t i) const { return values[i]; }
+
+  double deviation(size_t i) const { return (*this)[i].deviation(); }
+
+  // the arrays themselves; correlated uncertainties may be negative
+  const std::vector<double> &means() const { return values; }
+
+  const std::vector<double> &raw_uncertainties() const { return uncertainties; }
+
+  UDoubleMSBatch operator+() const & { return *this; }
+
+  UDoubleMSBatch operator+() && { return std::move(*this); }
+
+  UDoubleMSBatch operator-() const & {
+    UDoubleMSBatch retval(*this);
+    retval.apply(MSBatchOp1::negate);
+    return retval;
+  }
+
+  UDoubleMSBatch operator-() && {
+    apply(MSBatchOp1::negate);
+    return std::move(*this);
+  }
+
+  UDoubleMSBatch &operator+=(const UDoubleMSBatch &b) {
+    apply(MSBatchOp2::add, b);
+    return *this;
+  }
+
+  UDoubleMSBatch &operator+=(double b) {
+    apply(MSBatchOp2::add, b);
+    return *this;
+  }
+
+  UDoubleMSBatch &operator-=(const UDoubleMSBatch &b) {
+    apply(MSBatchOp2::sub, b);
+    return *this;
+  }
+
+  UDoubleMSBatch &operator-=(double b) {
+    apply(MSBatchOp2::sub, b);
+    return *this;
+  }
+
+  UDoubleMSBatch &operator*=(const UDoubleMSBatch &b) {
+    apply(MSBatchOp2::mul, b);
+    return *this;
+  }
+
+  UDoubleMSBatch &operator*=(double b) {
+    apply(MSBatchOp2::mul, b);
+    return *this;
+  }
+
+  UDoubleMSBatch &operator/=(const UDoubleMSBatch &b) {
+    apply(MSBatchOp2::div, b);
+    return *this;
+  }
+
+  UDoubleMSBatch &operator/=(double b) {
+    apply(MSBatchOp2::div, b);
+    return *this;
+  }
+
+  friend UDoubleMSBatch operator+(UDoubleMSBatch a, const UDoubleMSBatch &b) {
+    a += b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator+(UDoubleMSBatch a, double b) {
+    a += b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator+(double b, UDoubleMSBatch a) {
+    a += b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator-(UDoubleMSBatch a, const UDoubleMSBatch &b) {
+    a -= b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator-(UDoubleMSBatch a, double b) {
+    a -= b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator-(double b, UDoubleMSBatch a) {
+    a.apply_reversed(MSBatchOp2::sub, b);
+    return a;
+  }
+
+  friend UDoubleMSBatch operator*(UDoubleMSBatch a, const UDoubleMSBatch &b) {
+    a *= b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator*(UDoubleMSBatch a, double b) {
+    a *= b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator*(double b, UDoubleMSBatch a) {
+    a *= b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator/(UDoubleMSBatch a, const UDoubleMSBatch &b) {
+    a /= b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator/(UDoubleMSBatch a, double b) {
+    a /= b;
+    return a;
+  }
+
+  friend UDoubleMSBatch operator/(double b, UDoubleMSBatch a) {
+    a.apply_reversed(MSBatchOp2::div, b);
+    return a;
+  }
+
+#define UNCERTAIN_MS_BATCH_FUNC1(name)                                                             \
+  friend UDoubleMSBatch name(UDoubleMSBatch arg) {                                                 \
+    arg.apply(MSBatchOp1::name);                                                                   \
+    return arg;                                                                                    \
+  }
+#define UNCERTAIN_MS_BATCH_FUNC2(name)                                                             \
+  friend UDoubleMSBatch name(UDoubleMSBatch arg1, const UDoubleMSBatch &arg2) {                    \
+    arg1.apply(MSBatchOp2::name, arg2);                                                            \
+    return arg1;                                                                                   \
+  }                                                                                                \
+  friend UDoubleMSBatch name(UDoubleMSBatch arg1, double arg2) {                                   \
+    arg1.apply(MSBatchOp2::name, arg2);                                                            \
+    return arg1;                                                                                   \
+  }                                                                                                \
+  friend UDoubleMSBatch name(double arg1, UDoubleMSBatch arg2) {                                   \
+    arg2.apply_reversed(MSBatchOp2::name, arg1);                                                   \
+    return arg2;                                                                                   \
+  }
+  UNCERTAIN_MS_BATCH_FUNC1(sqrt)
+  UNCERTAIN_MS_BATCH_FUNC1(sin)
+  UNCERTAIN_MS_BATCH_FUNC1(cos)
+  UNCERTAIN_MS_BATCH_FUNC1(tan)
+  UNCERTAIN_MS_BATCH_FUNC1(asin)
+  UNCERTAIN_MS_BATCH_FUNC1(acos)
+  UNCERTAIN_MS_BATCH_FUNC1(atan)
+  UNCERTAIN_MS_BATCH_FUNC1(ceil)
+  UNCERTAIN_MS_BATCH_FUNC1(floor)
+  UNCERTAIN_MS_BATCH_FUNC1(fabs)
+  UNCERTAIN_MS_BATCH_FUNC1(exp)
+  UNCERTAIN_MS_BATCH_FUNC1(log)
+  UNCERTAIN_MS_BATCH_FUNC1(log10)
+  UNCERTAIN_MS_BATCH_FUNC1(sinh)
+  UNCERTAIN_MS_BATCH_FUNC1(cosh)
+  UNCERTAIN_MS_BATCH_FUNC1(tanh)
+  UNCERTAIN_MS_BATCH_FUNC2(fmod)
+  UNCERTAIN_MS_BATCH_FUNC2(atan2)
+  UNCERTAIN_MS_BATCH_FUNC2(pow)
+#undef UNCERTAIN_MS_BATCH_FUNC1
+#undef UNCERTAIN_MS_BATCH_FUNC2
+
+  // Applies func, any callable taking and returning UDoubleMS<is_correlated>,
+  // to every element.
+  template <class Func>
+  friend UDoubleMSBatch transform(UDoubleMSBatch arg, Func func) {
+    double *v = arg.values.data(), *u = arg.uncertainties.data();
+    parallel_for(arg.size(), kMinChunk, [=](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++)
+        MSBatchAccess::store(func(MSBatchAccess::load<is_correlated>(v, u, i)), v, u, i);
+    });
+    return arg;
+  }
+
+  // Applies func, any callable taking two UDoubleMS<is_correlated> values and
+  // returning one, to every pair of elements.
+  template <class Func>
+  friend UDoubleMSBatch transform(UDoubleMSBatch arg1, const UDoubleMSBatch &arg2, Func func) {
+    arg1.check_size(arg2);
+    double *v = arg1.values.data(), *u = arg1.uncertainties.data();
+    const double *v2 = arg2.values.data(), *u2 = arg2.uncertainties.data();
+    parallel_for(arg1.size(), kMinChunk, [=](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++)
+        MSBatchAccess::store(func(MSBatchAccess::load<is_correlated>(v, u, i),
+                                  MSBatchAccess::load<is_correlated>(v2, u2, i)),
+                             v, u, i);
+    });
+    return arg1;
+  }
+};
+
+// typedefs to hide the use of templates in the implementation
+using UDoubleMSUncorrBatch = UDoubleMSBatch<false>;
+using UDoubleMSCorrBatch = UDoubleMSBatch<true>;
+
+}  // namespace uncertain
@@ -0,0 +1,185 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// parallel.cpp: This file includes a small thread pool for splitting loops
+// over large arrays of uncertain values across cores.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <uncertain/parallel.hpp>
+#include <vector>
+
+namespace uncertain {
+
+namespace {
+
+// set while a thread runs chunks, so that nested loops run serially
+thread_local bool in_parallel_for = false;
+
+class ThreadPool {
+ public:
+  static ThreadPool &instance() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  size_t num_threads() {
+    std::lock_guard<std::mutex> lock(job_mutex);
+    return workers.size() + 1;
+  }
+
+  void resize(size_t num_threads) {
+    std::lock_guard<std::mutex> lock(job_mutex);
+    stop();
+    start(num_threads);
+  }
+
+  void run(size_t n, size_t chunk, const std::function<void(size_t, size_t)> &job_body) {
+    std::lock_guard<std::mutex> job_lock(job_mutex);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      body = &job_body;
+      job_size = n;
+      chunk_size = chunk;
+      next_chunk = 0;
+      error = nullptr;
+      active = workers.size();
+      generation++;
+    }
+    wake.notify_all();
+    run_chunks();
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return active == 0; });
+    body = nullptr;
+    if (error) std::rethrow_exception(error);
+  }
+
+ private:
+  std::mutex job_mutex;  // one loop at a time; guards workers
+  std::mutex mutex;      // guards the job description below
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::vector<std::thread> workers;
+  bool stopping{false};
+  size_t generation{0};
+
+  const std::function<void(size_t, size_t)> *body{nullptr};
+  size_t job_size{0};
+  size_t chunk_size{0};
+  std::atomic<size_t> next_chunk{0};
+  size_t active{0};  // workers that have not finished the current job
+  std::exception_ptr error;
+
+  ThreadPool() { start(0); }
+
+  ~ThreadPool() { stop(); }
+
+  void start(size_t num_threads) {
+    if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = false;
+    for (size_t i = 1; i < num_threads; i++)
+      workers.emplace_back(&ThreadPool::work, this, generation);
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) worker.join();
+    workers.clear();
+  }
+
+  void work(size_t seen_generation) {
+    in_parallel_for = true;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [&] { return stopping || (generation != seen_generation); });
+        if (stopping) return;
+        seen_generation = generation;
+      }
+      run_chunks();
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--active == 0) done.notify_one();
+    }
+  }
+
+  void run_chunks() {
+    for (;;) {
+      size_t begin = next_chunk.fetch_add(chunk_size);
+      if (begin >= job_size) return;
+      try {
+        (*body)(begin, std::min(begin + chunk_size, job_size));
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) error = std::current_exception();
+      }
+    }
+  }
+};
+
+}  // namespace
+
+void parallel_for(size_t n, size_t min_chunk,
+                  const std::function<void(size_t begin, size_t end)> &body) {
+  if (n == 0) return;
+  min_chunk = std::max<size_t>(min_chunk, 1);
+  ThreadPool &pool = ThreadPool::instance();
+  size_t num_threads = in_parallel_for ? 1 : pool.num_threads();
+  if ((num_threads == 1) || (n < 2 * min_chunk)) {
+    body(0, n);
+    return;
+  }
+  // a few chunks per thread evens out threads that start late
+  size_t chunk = std::max(min_chunk, (n + 4 * num_threads - 1) / (4 * num_threads));
+  in_parallel_for = true;
+  try {
+    pool.run(n, chunk, body);
+  } catch (...) {
+    in_parallel_for = false;
+    throw;
+  }
+  in_parallel_for = false;
+}
+
+size_t get_num_threads() { return ThreadPool::instance().num_threads(); }
+
+void set_num_threads(size_t num_threads) { ThreadPool::instance().resize(num_threads); }
+
+}  // namespace uncertain
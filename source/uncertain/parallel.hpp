@@ -0,0 +1,60 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// parallel.hpp: This file includes a small thread pool for splitting loops
+// over large arrays of uncertain values across cores.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace uncertain {
+
+// Runs body(begin, end) over consecutive chunks covering [0, n), on the
+// calling thread and the library's worker threads, and returns when all
+// chunks are done.  Chunks hold at least min_chunk elements; loops too
+// short to fill two chunks, and loops started from inside a body, run on
+// the calling thread alone.  The first exception thrown by a body is
+// rethrown to the caller once all chunks have finished.
+void parallel_for(size_t n, size_t min_chunk,
+                  const std::function<void(size_t begin, size_t end)> &body);
+
+// Number of threads parallel_for() uses, including the calling thread.
+// Defaults to the number of hardware threads.
+size_t get_num_threads();
+
+// Sets the number of threads for parallel_for(); 0 restores the default
+// and 1 disables the worker threads.
+void set_num_threads(size_t num_threads);
+
+}  // namespace uncertain
@@ -0,0 +1,139 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// random.hpp: This file includes the random number generator used to
+// shuffle the samples of the ensemble classes.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace uncertain {
+
+// One step of the SplitMix64 generator, used to expand seeds into the
+// state of Xoshiro256.
+inline uint64_t splitmix64(uint64_t &state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// The xoshiro256++ generator of Blackman and Vigna: 256 bits of state, a
+// period of 2^256 - 1 and a few cycles per number.  Each (seed, stream)
+// pair gives an independent sequence, so values made on different threads
+// can each use their own generator and still come out the same in every
+// run.  Meets the UniformRandomBitGenerator requirements of <random>.
+class Xoshiro256 {
+ private:
+  uint64_t s[4];
+
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+ public:
+  using result_type = uint64_t;
+
+  explicit Xoshiro256(uint64_t seed = 0, uint64_t stream = 0) {
+    uint64_t state = seed;
+    uint64_t stream_state = stream;
+    state ^= splitmix64(stream_state);
+    for (auto &word : s) word = splitmix64(state);
+  }
+
+  static constexpr result_type min() { return 0; }
+
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  result_type operator()() {
+    const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+  }
+
+  // a uniformly distributed integer in [0, range), without the bias of
+  // taking a remainder (Lemire's multiply-and-reject method)
+  uint64_t below(uint64_t range) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 m = static_cast<uint128>((*this)()) * range;
+    uint64_t low = static_cast<uint64_t>(m);
+    if (low < range) {
+      const uint64_t threshold = (0 - range) % range;
+      while (low < threshold) {
+        m = static_cast<uint128>((*this)()) * range;
+        low = static_cast<uint64_t>(m);
+      }
+    }
+    return static_cast<uint64_t>(m >> 64);
+#else
+    const uint64_t limit = max() - max() % range;
+    uint64_t x;
+    do x = (*this)();
+    while (x >= limit);
+    return x % range;
+#endif
+  }
+};
+
+// A generator private to the calling thread, for shuffles that need not
+// be reproducible.  Its streams are kept apart from the ones numbered by
+// sources of uncertainty.
+inline Xoshiro256 &thread_engine() {
+  static std::atomic<uint64_t> next_stream{0};
+  thread_local Xoshiro256 engine(0, (uint64_t(1) << 63) | next_stream.fetch_add(1));
+  return engine;
+}
+
+// Fisher-Yates shuffle of n values with any generator with a below()
+// member like Xoshiro256's.
+template <class Engine>
+void shuffle_values(double *values, size_t n, Engine &engine) {
+  for (size_t i = 0; i + 1 < n; i++) {
+    size_t j = i + static_cast<size_t>(engine.below(n - i));
+    if (j != i) {
+      double temp = values[i];
+      values[i] = values[j];
+      values[j] = temp;
+    }
+  }
+}
+
+}  // namespace uncertain
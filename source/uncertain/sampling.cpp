@@ -0,0 +1,129 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// sampling.cpp: This file includes the Latin hypercube and the scrambled
+// Sobol sampling of new sources of uncertainty of the ensemble classes.
+
+#include <uncertain/sampling.hpp>
+
+namespace uncertain {
+
+namespace {
+
+// The primitive polynomials and initial direction numbers of the Sobol
+// dimensions after the first, from Joe and Kuo's new-joe-kuo-6.21201.
+struct SobolPolynomial {
+  unsigned degree;
+  uint32_t coefficients;
+  uint32_t initial[3];
+};
+
+constexpr SobolPolynomial kSobolPolynomials[kSobolDimensions - 1] = {
+    {1, 0, {1}}, {2, 1, {1, 3}}, {3, 1, {1, 3, 1}}};
+
+// The generator matrices of the sequence, as one column of 32 bits for
+// each bit of the index.
+struct SobolMatrices {
+  uint32_t v[kSobolDimensions][32];
+
+  constexpr SobolMatrices() : v() {
+    for (unsigned k = 0; k < 32; k++) v[0][k] = uint32_t(1) << (31 - k);
+    for (size_t d = 1; d < kSobolDimensions; d++) {
+      const SobolPolynomial &p = kSobolPolynomials[d - 1];
+      for (unsigned k = 0; k < 32; k++) {
+        if (k < p.degree) {
+          v[d][k] = p.initial[k] << (31 - k);
+          continue;
+        }
+        uint32_t x = v[d][k - p.degree] ^ (v[d][k - p.degree] >> p.degree);
+        for (unsigned j = 1; j < p.degree; j++)
+          if ((p.coefficients >> (p.degree - 1 - j)) & 1) x ^= v[d][k - j];
+        v[d][k] = x;
+      }
+    }
+  }
+};
+
+constexpr SobolMatrices kSobol;
+
+uint32_t sobol(size_t dimension, uint32_t index) {
+  uint32_t x = 0;
+  for (unsigned k = 0; index; index >>= 1, k++)
+    if (index & 1) x ^= kSobol.v[dimension][k];
+  return x;
+}
+
+uint32_t reverse_bits(uint32_t x) {
+  x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+  x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+  x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+  x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+// Owen scrambling: each bit is flipped by a hash of the bits above it,
+// which moves the points at random within their strata without breaking
+// the strata up.  The hash is Vegdahl's improvement of Laine and Karras'.
+uint32_t owen_scramble(uint32_t x, uint32_t seed) {
+  x = reverse_bits(x);
+  x ^= x * 0x3d20adeau;
+  x += seed;
+  x *= (seed >> 16) | 1;
+  x ^= x * 0x05526c56u;
+  x ^= x * 0x53a22864u;
+  return reverse_bits(x);
+}
+
+}  // namespace
+
+void latin_hypercube_uniforms(double *u, size_t n, Xoshiro256 &engine) {
+  for (size_t i = 0; i < n; i++) {
+    // 53 random bits, centered so that neither end of the slice is hit
+    double place = ((engine() >> 11) + 0.5) * 0x1p-53;
+    u[i] = (i + place) / n;
+  }
+  shuffle_values(u, n, engine);
+}
+
+void sobol_uniforms(double *u, size_t n, size_t dimension, uint64_t seed) {
+  uint64_t state = seed ^ (0x9e3779b97f4a7c15ull * (dimension + 1));
+  uint32_t scramble = uint32_t(splitmix64(state) >> 32);
+  size_t sobol_dimension = dimension % kSobolDimensions;
+  for (size_t i = 0; i < n; i++)
+    u[i] = (owen_scramble(sobol(sobol_dimension, uint32_t(i)), scramble) + 0.5) * 0x1p-32;
+
+  // one order for the group, from a stream apart from the ones of sources
+  Xoshiro256 engine(seed, (uint64_t(1) << 62) | (dimension / kSobolDimensions));
+  shuffle_values(u, n, engine);
+}
+
+}  // namespace uncertain
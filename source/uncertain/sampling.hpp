@@ -0,0 +1,75 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// sampling.hpp: This file includes the ways the ensemble classes can place
+// the samples of a new source of uncertainty.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <uncertain/random.hpp>
+
+namespace uncertain {
+
+// How UDoubleEnsemble samples a new source of uncertainty.
+enum class EnsembleSampling {
+  // The perfected Gaussian basis, shuffled: the first 5 moments are exact,
+  // the pairing with other sources is random.
+  shuffled_basis,
+  // Latin hypercube: one sample in each of the n slices of equal
+  // probability, at a random place within it, paired at random.
+  latin_hypercube,
+  // Owen-scrambled Sobol points: stratified like the Latin hypercube, and
+  // sources made one after another are also paired more evenly with each
+  // other, so spurious correlations between them fall off like 1/n rather
+  // than 1/sqrt(n).  Best with n a power of 2.
+  sobol
+};
+
+// The Sobol dimensions used.  Source k takes dimension k % kSobolDimensions
+// and is paired evenly with the other sources of its group of
+// kSobolDimensions consecutive sources, at random with the rest; the low
+// dimensions have the best pairings for small n (Burley, "Practical
+// Hash-based Owen Scrambling", 2020).
+constexpr size_t kSobolDimensions = 4;
+
+// Fills u with n uniform deviates in (0, 1), one in each slice [i/n, (i+1)/n),
+// in random order.
+void latin_hypercube_uniforms(double *u, size_t n, Xoshiro256 &engine);
+
+// Fills u with the first n points of the given dimension of an Owen-scrambled
+// Sobol sequence, in (0, 1).  The dimensions of a group are given the same
+// random order, so their points stay paired.
+void sobol_uniforms(double *u, size_t n, size_t dimension, uint64_t seed);
+
+}  // namespace uncertain
@@ -56,6 +56,12 @@ class ScaledArray {
 
   ScaledArray(const ScaledArray &a) = default;
 
+  ScaledArray(ScaledArray &&a) noexcept = default;
+
+  ScaledArray &operator=(const ScaledArray &a) = default;
+
+  ScaledArray &operator=(ScaledArray &&a) noexcept = default;
+
   ~ScaledArray() = default;
 
   ScaledArray operator-() const {
@@ -98,6 +104,19 @@ class ScaledArray {
 
   friend ScaledArray operator*(ScaledArray a, double b) { return a *= b; }
 
+  // adds b * factor to this array without creating a temporary
+  ScaledArray &add_scaled(const ScaledArray &b, double factor) {
+    if (scale != 0.0) {
+      if (elements.size() < b.elements.size()) elements.resize(b.elements.size(), 0.0);
+      double scale_factor = b.scale * factor / scale;
+      for (size_t i = 0; i < b.elements.size(); i++) elements[i] += b.elements[i] * scale_factor;
+    } else {
+      scale = b.scale * factor;
+      elements = b.elements;
+    }
+    return *this;
+  }
+
   ScaledArray &operator/=(double b) {
     scale /= b;
     return *this;
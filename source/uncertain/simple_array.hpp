@@ -53,6 +53,12 @@ class SimpleArray {
 
   SimpleArray(const SimpleArray &a) = default;
 
+  SimpleArray(SimpleArray &&a) noexcept = default;
+
+  SimpleArray &operator=(const SimpleArray &a) = default;
+
+  SimpleArray &operator=(SimpleArray &&a) noexcept = default;
+
   ~SimpleArray() = default;
 
   SimpleArray operator-() const {
@@ -82,6 +88,13 @@ class SimpleArray {
 
   friend SimpleArray operator*(SimpleArray a, double b) { return a *= b; }
 
+  // adds b * factor to this array without creating a temporary
+  SimpleArray &add_scaled(const SimpleArray &b, double factor) {
+    if (elements.size() < b.elements.size()) elements.resize(b.elements.size(), 0.0);
+    for (size_t i = 0; i < b.elements.size(); i++) elements[i] += b.elements[i] * factor;
+    return *this;
+  }
+
   SimpleArray &operator/=(double b) {
     for (auto &e : elements) e /= b;
     return *this;
@@ -0,0 +1,220 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// small_array.hpp: This file includes a small-buffer-optimized array of
+// uncertainty components for the correlation tracking class UDoubleCT<>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <uncertain/functions.hpp>
+#include <utility>
+#include <vector>
+
+namespace uncertain {
+
+// Specialized array class has only those members needed to be an array
+// of uncertainty elements used as the template parameter in UDoubleCT<>.
+// Like SparseArray it stores only the non-zero elements, as source numbers
+// sorted in increasing order with their values, but it keeps up to
+// inline_size of them inside the object itself and only allocates memory
+// on the heap for more.  Values that depend on only a few sources, however
+// late they were created, can therefore be copied and combined without any
+// allocation.
+template <size_t inline_size>
+class SmallArray {
+ private:
+  size_t count{0};  // the number of non-zero elements
+  std::array<size_t, inline_size> local_indices{};
+  std::array<double, inline_size> local_elements{};
+  // all the elements once there are more than inline_size of them
+  std::vector<size_t> heap_indices;
+  std::vector<double> heap_elements;
+
+  const size_t *indices() const {
+    return is_inline() ? local_indices.data() : heap_indices.data();
+  }
+
+  double *elements() { return is_inline() ? local_elements.data() : heap_elements.data(); }
+
+  const double *elements() const {
+    return is_inline() ? local_elements.data() : heap_elements.data();
+  }
+
+  // adds an element past the last one, moving to the heap when the inline
+  // buffer is full
+  void append(size_t idx, double value) {
+    if (count < inline_size) {
+      local_indices[count] = idx;
+      local_elements[count] = value;
+    } else {
+      if (count == inline_size) {
+        heap_indices.assign(local_indices.begin(), local_indices.end());
+        heap_elements.assign(local_elements.begin(), local_elements.end());
+      }
+      heap_indices.push_back(idx);
+      heap_elements.push_back(value);
+    }
+    count++;
+  }
+
+  // Merges b * factor into this array in a single linear pass over both
+  // sorted index lists.  Elements that cancel out exactly are dropped.
+  void merge(const SmallArray &b, double factor) {
+    if ((b.count == 0) || (factor == 0.0)) return;
+    SmallArray result;
+    if (count + b.count > inline_size) {
+      result.heap_indices.reserve(count + b.count);
+      result.heap_elements.reserve(count + b.count);
+    }
+    const size_t *ai = indices(), *bi = b.indices();
+    const double *ae = elements(), *be = b.elements();
+    size_t i = 0, j = 0;
+    while ((i < count) && (j < b.count)) {
+      if (ai[i] < bi[j]) {
+        result.append(ai[i], ae[i]);
+        i++;
+      } else if (bi[j] < ai[i]) {
+        result.append(bi[j], be[j] * factor);
+        j++;
+      } else {
+        double sum = ae[i] + be[j] * factor;
+        if (sum != 0.0) result.append(ai[i], sum);
+        i++;
+        j++;
+      }
+    }
+    for (; i < count; i++) result.append(ai[i], ae[i]);
+    for (; j < b.count; j++) result.append(bi[j], be[j] * factor);
+    *this = std::move(result);
+  }
+
+ public:
+  SmallArray() = default;
+
+  SmallArray(const SmallArray &a) = default;
+
+  SmallArray(SmallArray &&a) noexcept = default;
+
+  SmallArray &operator=(const SmallArray &a) = default;
+
+  SmallArray &operator=(SmallArray &&a) noexcept = default;
+
+  ~SmallArray() = default;
+
+  SmallArray operator-() const {
+    SmallArray retval = *this;
+    double *e = retval.elements();
+    for (size_t i = 0; i < count; i++) e[i] = -e[i];
+    return retval;
+  }
+
+  SmallArray &operator+=(const SmallArray &b) {
+    merge(b, 1.0);
+    return *this;
+  }
+
+  friend SmallArray operator+(SmallArray a, const SmallArray &b) { return a += b; }
+
+  SmallArray &operator-=(const SmallArray &b) {
+    merge(b, -1.0);
+    return *this;
+  }
+
+  SmallArray &operator*=(double b) {
+    if (b == 0.0) {
+      *this = SmallArray();
+      return *this;
+    }
+    double *e = elements();
+    for (size_t i = 0; i < count; i++) e[i] *= b;
+    return *this;
+  }
+
+  friend SmallArray operator*(SmallArray a, double b) { return a *= b; }
+
+  // adds b * factor to this array without creating a temporary
+  SmallArray &add_scaled(const SmallArray &b, double factor) {
+    merge(b, factor);
+    return *this;
+  }
+
+  SmallArray &operator/=(double b) {
+    double *e = elements();
+    for (size_t i = 0; i < count; i++) e[i] /= b;
+    return *this;
+  }
+
+  double operator[](size_t subscript) const {
+    const size_t *first = indices(), *last = first + count;
+    const size_t *it = std::lower_bound(first, last, subscript);
+    if ((it == last) || (*it != subscript)) return 0.0;
+    return elements()[it - first];
+  }
+
+  void set_element(size_t idx, double value) {
+    // new sources come last, so the common case is an append
+    if ((count == 0) || (idx > indices()[count - 1])) {
+      if (value != 0.0) append(idx, value);
+      return;
+    }
+    SmallArray result;
+    const size_t *ai = indices();
+    const double *ae = elements();
+    bool placed = false;
+    for (size_t i = 0; i < count; i++) {
+      if (!placed && (idx <= ai[i])) {
+        if (value != 0.0) result.append(idx, value);
+        placed = true;
+        if (idx == ai[i]) continue;
+      }
+      result.append(ai[i], ae[i]);
+    }
+    *this = std::move(result);
+  }
+
+  // true if all elements fit in the inline buffer
+  bool is_inline() const { return count <= inline_size; }
+
+  // number of sources with a non-zero element
+  size_t num_nonzero() const { return count; }
+
+  double norm() const {
+    double tot = 0.0;
+    const double *e = elements();
+    for (size_t i = 0; i < count; i++) tot += sqr(e[i]);
+    return std::sqrt(tot);
+  }
+};
+
+}  // namespace uncertain
@@ -36,51 +36,136 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <uncertain/functions.hpp>
+#include <utility>
 #include <vector>
 
 namespace uncertain {
 
 // A class for sources of uncertainties.
+//
+// Sources may be created from any number of threads at once.  Source
+// numbers are reserved with an atomic counter, and each thread records the
+// names of its sources in a buffer of its own, so creating sources never
+// waits on other threads.  The buffers are merged into one list of names
+// only when a name is looked up.
+//
+// Epochs are shared by all threads: new_epoch() invalidates every value of
+// the class, whichever thread made it, and restarts source numbering.  A
+// source created while new_epoch() runs on another thread belongs
+// entirely to either the old or the new epoch, and get_new_source()
+// reports which.
 class SourceSet {
  private:
-  size_t source_epoch{0};
-  std::vector<std::string> source_names;
+  // names of the sources created by one thread since the last merge
+  struct NameBuffer {
+    std::mutex mutex;
+    std::vector<std::pair<size_t, std::string>> names;
+  };
+
+  std::atomic<size_t> source_epoch{0};
+  std::atomic<size_t> num_sources{0};
   std::string class_name;
+  const uint64_t instance{next_instance++};  // tells SourceSets apart in thread caches
+
+  mutable std::mutex registry_mutex;  // guards buffers and source_names
+  mutable std::vector<std::shared_ptr<NameBuffer>> buffers;
+  mutable std::vector<std::string> source_names;
+
+  inline static std::atomic<uint64_t> next_instance{0};
+
+  NameBuffer &thread_buffer() {
+    thread_local std::vector<std::pair<uint64_t, std::shared_ptr<NameBuffer>>> thread_buffers;
+    for (const auto &entry : thread_buffers)
+      if (entry.first == instance) return *entry.second;
+    auto buffer = std::make_shared<NameBuffer>();
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex);
+      buffers.push_back(buffer);
+    }
+    thread_buffers.emplace_back(instance, buffer);
+    return *buffer;
+  }
+
+  // moves the buffered names into source_names; registry_mutex must be held
+  void merge() const {
+    for (size_t b = 0; b < buffers.size();) {
+      {
+        std::lock_guard<std::mutex> lock(buffers[b]->mutex);
+        for (auto &entry : buffers[b]->names) {
+          if (entry.first >= source_names.size()) source_names.resize(entry.first + 1);
+          source_names[entry.first] = std::move(entry.second);
+        }
+        buffers[b]->names.clear();
+      }
+      // drop the buffers of threads that have exited
+      if (buffers[b].use_count() == 1) {
+        buffers[b] = std::move(buffers.back());
+        buffers.pop_back();
+      } else
+        b++;
+    }
+  }
 
  public:
   SourceSet(const std::string &cname = {}) : class_name(cname) {}
 
-  // \todo reserve
+  SourceSet(const SourceSet &) = delete;
+  SourceSet &operator=(const SourceSet &) = delete;
 
-  size_t get_epoch() const { return source_epoch; }
+  size_t get_epoch() const { return source_epoch.load(std::memory_order_acquire); }
 
   void check_epoch(size_t epoch) const {
-    if (epoch != source_epoch) {
+    size_t current = get_epoch();
+    if (epoch != current) {
       throw std::runtime_error("Wrong epoch: " + std::to_string(epoch) + " expected: " +
-                               std::to_string(source_epoch) + " in class " + class_name);
+                               std::to_string(current) + " in class " + class_name);
     }
   }
 
   void new_epoch() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::vector<std::unique_lock<std::mutex>> buffer_locks;
+    for (auto &buffer : buffers) {
+      buffer_locks.emplace_back(buffer->mutex);
+      buffer->names.clear();
+    }
     source_names.clear();
-    source_epoch++;
+    num_sources.store(0, std::memory_order_relaxed);
+    source_epoch.fetch_add(1, std::memory_order_release);
+  }
+
+  // Returns the number of the new source and sets epoch to the epoch it
+  // belongs to.
+  size_t get_new_source(std::string name, size_t &epoch) {
+    NameBuffer &buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    epoch = source_epoch.load(std::memory_order_relaxed);
+    size_t source_num = num_sources.fetch_add(1, std::memory_order_acq_rel);
+    buffer.names.emplace_back(source_num, std::move(name));
+    return source_num;
   }
 
   size_t get_new_source(std::string name) {
-    source_names.push_back(name);
-    return source_names.size() - 1;
+    size_t epoch;
+    return get_new_source(std::move(name), epoch);
   }
 
-  size_t get_num_sources() const { return source_names.size(); }
+  size_t get_num_sources() const { return num_sources.load(std::memory_order_acquire); }
 
   std::string get_source_name(size_t i) const {
-    if (i >= source_names.size()) {
+    if (i >= get_num_sources()) {
       throw std::runtime_error("get_source_name called with illegal source number: " +
                                std::to_string(i));
     }
-    return source_names[i];
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if ((i >= source_names.size()) || source_names[i].empty()) merge();
+    return (i < source_names.size()) ? source_names[i] : std::string();
   }
 };
 
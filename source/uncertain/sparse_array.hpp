@@ -0,0 +1,188 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// sparse_array.hpp: This file includes a sparse array of uncertainty
+// components for the correlation tracking class UDoubleCT<>.
+
+#pragma once
+
+#include <algorithm>
+#include <uncertain/functions.hpp>
+#include <vector>
+
+namespace uncertain {
+
+// Specialized array class has only those members needed to be an array
+// of uncertainty elements used as the template parameter in UDoubleCT<>.
+// Unlike SimpleArray, only the non-zero elements are stored, as a list of
+// source numbers sorted in increasing order with a parallel list of values.
+// Memory use and the cost of arithmetic are then proportional to the number
+// of sources a value actually depends on rather than to the total number of
+// sources, at the price of a binary search for random access.
+class SparseArray {
+ private:
+  std::vector<size_t> indices;
+  std::vector<double> elements;
+
+  // Merges b * factor into this array in a single linear pass over both
+  // sorted index lists.  Elements that cancel out exactly are dropped.
+  void merge(const SparseArray &b, double factor) {
+    if (b.indices.empty() || (factor == 0.0)) return;
+    if (indices.empty()) {
+      indices = b.indices;
+      elements.resize(b.elements.size());
+      for (size_t i = 0; i < b.elements.size(); i++) elements[i] = b.elements[i] * factor;
+      return;
+    }
+    std::vector<size_t> new_indices;
+    std::vector<double> new_elements;
+    new_indices.reserve(indices.size() + b.indices.size());
+    new_elements.reserve(indices.size() + b.indices.size());
+    size_t i = 0, j = 0;
+    while ((i < indices.size()) && (j < b.indices.size())) {
+      if (indices[i] < b.indices[j]) {
+        new_indices.push_back(indices[i]);
+        new_elements.push_back(elements[i]);
+        i++;
+      } else if (b.indices[j] < indices[i]) {
+        new_indices.push_back(b.indices[j]);
+        new_elements.push_back(b.elements[j] * factor);
+        j++;
+      } else {
+        double sum = elements[i] + b.elements[j] * factor;
+        if (sum != 0.0) {
+          new_indices.push_back(indices[i]);
+          new_elements.push_back(sum);
+        }
+        i++;
+        j++;
+      }
+    }
+    for (; i < indices.size(); i++) {
+      new_indices.push_back(indices[i]);
+      new_elements.push_back(elements[i]);
+    }
+    for (; j < b.indices.size(); j++) {
+      new_indices.push_back(b.indices[j]);
+      new_elements.push_back(b.elements[j] * factor);
+    }
+    indices.swap(new_indices);
+    elements.swap(new_elements);
+  }
+
+ public:
+  SparseArray() = default;
+
+  SparseArray(const SparseArray &a) = default;
+
+  SparseArray(SparseArray &&a) noexcept = default;
+
+  SparseArray &operator=(const SparseArray &a) = default;
+
+  SparseArray &operator=(SparseArray &&a) noexcept = default;
+
+  ~SparseArray() = default;
+
+  SparseArray operator-() const {
+    SparseArray retval = *this;
+    for (auto &e : retval.elements) e = -e;
+    return retval;
+  }
+
+  SparseArray &operator+=(const SparseArray &b) {
+    merge(b, 1.0);
+    return *this;
+  }
+
+  friend SparseArray operator+(SparseArray a, const SparseArray &b) { return a += b; }
+
+  SparseArray &operator-=(const SparseArray &b) {
+    merge(b, -1.0);
+    return *this;
+  }
+
+  SparseArray &operator*=(double b) {
+    if (b == 0.0) {
+      indices.clear();
+      elements.clear();
+      return *this;
+    }
+    for (auto &e : elements) e *= b;
+    return *this;
+  }
+
+  friend SparseArray operator*(SparseArray a, double b) { return a *= b; }
+
+  // adds b * factor to this array without creating a temporary
+  SparseArray &add_scaled(const SparseArray &b, double factor) {
+    merge(b, factor);
+    return *this;
+  }
+
+  SparseArray &operator/=(double b) {
+    for (auto &e : elements) e /= b;
+    return *this;
+  }
+
+  double operator[](size_t subscript) const {
+    auto it = std::lower_bound(indices.begin(), indices.end(), subscript);
+    if ((it == indices.end()) || (*it != subscript)) return 0.0;
+    return elements[it - indices.begin()];
+  }
+
+  void set_element(size_t idx, double value) {
+    auto it = std::lower_bound(indices.begin(), indices.end(), idx);
+    auto pos = it - indices.begin();
+    if ((it != indices.end()) && (*it == idx)) {
+      if (value != 0.0) {
+        elements[pos] = value;
+      } else {
+        indices.erase(it);
+        elements.erase(elements.begin() + pos);
+      }
+    } else if (value != 0.0) {
+      indices.insert(it, idx);
+      elements.insert(elements.begin() + pos, value);
+    }
+  }
+
+  // number of sources with a non-zero element
+  size_t num_nonzero() const { return indices.size(); }
+
+  double norm() const {
+    double tot = 0.0;
+    for (const auto &e : elements) tot += sqr(e);
+    return std::sqrt(tot);
+  }
+};
+
+}  // namespace uncertain
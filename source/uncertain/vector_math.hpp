@@ -0,0 +1,76 @@
+// License Terms
+//
+// Copyright (c) 2019, California Institute of Technology ("Caltech").
+// U.S. Government sponsorship acknowledged.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions must reproduce the above copyright notice, this list
+//       of conditions and the following disclaimer in the documentation and/or
+//       other materials provided with the distribution.
+//     * Neither the name of Caltech nor its operating division, the Jet
+//       Propulsion Laboratory, nor the names of its contributors may be used
+//       to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// vector_math.hpp: This file includes compiler settings shared by the
+// translation units that hold the library's loop kernels.  It is private
+// to the library and not installed.
+
+#pragma once
+
+#include <cmath>
+
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__ELF__)
+// compile each kernel for several instruction sets, chosen at load time
+#define UNCERTAIN_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define UNCERTAIN_TARGET_CLONES
+#endif
+
+#if defined(UNCERTAIN_VECTOR_MATH) && defined(__x86_64__) && defined(__GNUC__) && \
+    defined(__GLIBC__)
+// glibc only declares the vector variants in libmvec when compiling with
+// -ffast-math, which would also change the meaning of the arithmetic.
+// Redeclaring the functions with the simd attribute lets the compiler
+// vectorize the kernel loops with the libmvec variants on its own.  hypot
+// is left out: the batch arithmetic in ms_batch.cpp has its own.
+#define UNCERTAIN_SIMD_DECL __attribute__((__simd__("notinbranch")))
+extern "C" {
+#if __GLIBC_PREREQ(2, 22)
+UNCERTAIN_SIMD_DECL double sin(double) noexcept;
+UNCERTAIN_SIMD_DECL double cos(double) noexcept;
+UNCERTAIN_SIMD_DECL double exp(double) noexcept;
+UNCERTAIN_SIMD_DECL double log(double) noexcept;
+UNCERTAIN_SIMD_DECL double pow(double, double) noexcept;
+#endif
+#if __GLIBC_PREREQ(2, 35)
+UNCERTAIN_SIMD_DECL double tan(double) noexcept;
+UNCERTAIN_SIMD_DECL double asin(double) noexcept;
+UNCERTAIN_SIMD_DECL double acos(double) noexcept;
+UNCERTAIN_SIMD_DECL double atan(double) noexcept;
+UNCERTAIN_SIMD_DECL double log10(double) noexcept;
+UNCERTAIN_SIMD_DECL double sinh(double) noexcept;
+UNCERTAIN_SIMD_DECL double cosh(double) noexcept;
+UNCERTAIN_SIMD_DECL double tanh(double) noexcept;
+UNCERTAIN_SIMD_DECL double atan2(double, double) noexcept;
+#endif
+}
+#endif
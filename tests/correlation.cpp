@@ -0,0 +1,94 @@
+#include <cmath>
+#include <complex>
+#include <uncertain/correlation.hpp>
+#include <uncertain/double_ensemble.hpp>
+#include <uncertain/random.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+namespace uncertain {
+
+// the statics are defined with the other tests of the class, in double_ensemble.cpp
+using EnsembleLarge = UDoubleEnsemble<1024>;
+
+template <>
+SourceSet EnsembleLarge::sources;
+
+template <>
+std::vector<std::vector<double>> EnsembleLarge::src_ensemble;
+
+template <>
+std::vector<double> EnsembleLarge::gauss_ensemble;
+
+}  // namespace uncertain
+
+static double uniform(uncertain::Xoshiro256 &engine) { return (engine() >> 11) * 0x1.0p-53; }
+
+TEST(Correlation, FftMatchesDft) {
+  const double pi = 3.14159265358979323846;
+  uncertain::Xoshiro256 engine(4, 0);
+  for (size_t n : {1u, 2u, 8u, 12u, 97u, 256u}) {
+    std::vector<std::complex<double>> x(n);
+    for (auto &v : x) v = {uniform(engine) - 0.5, uniform(engine) - 0.5};
+    std::vector<std::complex<double>> y = x;
+    uncertain::fft(y.data(), n);
+    for (size_t k = 0; k < n; k++) {
+      std::complex<double> expected = 0.0;
+      for (size_t j = 0; j < n; j++) expected += x[j] * std::polar(1.0, -2 * pi * j * k / n);
+      EXPECT_NEAR(std::abs(y[k] - expected), 0.0, 1e-11) << n << " " << k;
+    }
+    uncertain::fft(y.data(), n, true);
+    for (size_t j = 0; j < n; j++) EXPECT_NEAR(std::abs(y[j] / double(n) - x[j]), 0.0, 1e-14);
+  }
+}
+
+TEST(Correlation, LagCorrelations) {
+  uncertain::Xoshiro256 engine(6, 0);
+  for (size_t n : {64u, 100u}) {
+    std::vector<double> a(n), b(n);
+    for (size_t i = 0; i < n; i++) {
+      a[i] = uniform(engine);
+      b[i] = 3.0 + uniform(engine);
+    }
+    // b holds a rotated by 7 with some noise
+    for (size_t i = 0; i < n; i++) b[(i + 7) % n] += 4.0 * a[i];
+
+    std::vector<double> r = uncertain::lag_correlations(a.data(), b.data(), n);
+    ASSERT_EQ(r.size(), n);
+    double mean_a = 0, mean_b = 0;
+    for (size_t i = 0; i < n; i++) {
+      mean_a += a[i] / n;
+      mean_b += b[i] / n;
+    }
+    for (size_t k = 0; k < n; k++) {
+      double c = 0, m2_a = 0, m2_b = 0;
+      for (size_t i = 0; i < n; i++) {
+        double da = a[i] - mean_a, db = b[(i + k) % n] - mean_b;
+        c += da * db;
+        m2_a += da * da;
+        m2_b += db * db;
+      }
+      EXPECT_NEAR(r[k], c / std::sqrt(m2_a * m2_b), 1e-12) << n << " " << k;
+    }
+    EXPECT_GT(r[7], 0.9);
+  }
+
+  std::vector<double> flat(10, 1.0), ramp(10);
+  for (size_t i = 0; i < 10; i++) ramp[i] = i;
+  EXPECT_EQ(uncertain::lag_correlations(flat.data(), ramp.data(), 10),
+            std::vector<double>(10, 0.0));
+}
+
+TEST(Correlation, EnsembleLagCorrelations) {
+  using uncertain::EnsembleLarge;
+  const size_t n = 1024;
+  EnsembleLarge::new_epoch();
+  EnsembleLarge a(1.0, 0.5), b(2.0, 0.25), c = a + 0.5 * b;
+  std::vector<double> r = c.lag_correlations(b);
+  ASSERT_EQ(r.size(), n);
+  for (size_t offset = 0; offset < n; offset++)
+    EXPECT_NEAR(r[offset], c.correlation(b, offset), 1e-12) << offset;
+  EXPECT_NEAR(b.covariance(b), b.deviation() * b.deviation(), 1e-12);
+  EXPECT_NEAR(c.covariance(b, 3), c.correlation(b, 3) * c.deviation() * b.deviation(), 1e-12);
+}
@@ -0,0 +1,203 @@
+#include <cmath>
+#include <sstream>
+#include <type_traits>
+#include <uncertain/double_ct.hpp>
+#include <uncertain/scaled_array.hpp>
+#include <uncertain/simple_array.hpp>
+#include <uncertain/small_array.hpp>
+#include <uncertain/sparse_array.hpp>
+
+#include "test_lib/gtest_print.hpp"
+
+namespace uncertain {
+
+template <>
+SourceSet UDoubleCT<SmallArray<2>>::sources("Small Array 2");
+
+template <>
+SourceSet UDoubleCT<SmallArray<16>>::sources("Small Array 16");
+
+}  // namespace uncertain
+
+template <class T>
+class CTOperatorsTest : public TestBase {
+  virtual void SetUp() { uncertain::UDoubleCT<T>::new_epoch(); }
+
+  virtual void TearDown() {}
+};
+
+using ArrayTypes = ::testing::Types<uncertain::SmallArray<2>, uncertain::SmallArray<16>>;
+TYPED_TEST_SUITE(CTOperatorsTest, ArrayTypes);
+
+TYPED_TEST(CTOperatorsTest, ChainMatchesCompound) {
+  using UD = uncertain::UDoubleCT<TypeParam>;
+  UD a(2.0, 0.1), b(3.0, 0.2), c(4.0, 0.3), d(5.0, 0.4), e(6.0, 0.5);
+
+  UD chain = a * b + c / d - e;
+
+  UD ab(a);
+  ab *= b;
+  UD cd(c);
+  cd /= d;
+  UD expected(ab);
+  expected += cd;
+  expected -= e;
+
+  EXPECT_DOUBLE_EQ(chain.mean(), expected.mean());
+  EXPECT_DOUBLE_EQ(chain.deviation(), expected.deviation());
+}
+
+TYPED_TEST(CTOperatorsTest, ScalarOperands) {
+  using UD = uncertain::UDoubleCT<TypeParam>;
+  UD a(2.0, 0.5);
+
+  UD r = 1.0 - 3.0 * a / 2.0 + 4.0 / a;
+  EXPECT_DOUBLE_EQ(r.mean(), 1.0 - 3.0 + 2.0);
+  // slope: -3/2 - 4/a^2 = -2.5
+  EXPECT_DOUBLE_EQ(r.deviation(), 2.5 * 0.5);
+
+  UD n = -(a + 1.0);
+  EXPECT_DOUBLE_EQ(n.mean(), -3.0);
+  EXPECT_DOUBLE_EQ(n.deviation(), 0.5);
+}
+
+TYPED_TEST(CTOperatorsTest, CorrelationsCancel) {
+  using UD = uncertain::UDoubleCT<TypeParam>;
+  UD a(2.0, 0.5), b(1.0, 0.25);
+
+  UD r = (a + b) - (b + a);
+  EXPECT_DOUBLE_EQ(r.mean(), 0.0);
+  EXPECT_DOUBLE_EQ(r.deviation(), 0.0);
+}
+
+TYPED_TEST(CTOperatorsTest, TemporariesAndAliasing) {
+  using UD = uncertain::UDoubleCT<TypeParam>;
+  UD a(2.0, 0.5), b(1.0, 0.25);
+
+  // sqrt() returns a temporary that is moved into the expression
+  UD r = sqrt(a * a) + b;
+  EXPECT_DOUBLE_EQ(r.mean(), 3.0);
+  EXPECT_DOUBLE_EQ(r.deviation(), std::hypot(0.5, 0.25));
+
+  // math functions accept arithmetic results
+  UD s = sqrt(a + b + 1.0);
+  EXPECT_DOUBLE_EQ(s.mean(), 2.0);
+
+  a = a * b + a;
+  EXPECT_DOUBLE_EQ(a.mean(), 4.0);
+  EXPECT_DOUBLE_EQ(a.deviation(), std::hypot(0.5 * 2.0, 0.25 * 2.0));
+
+  b += b * 2.0;
+  EXPECT_DOUBLE_EQ(b.mean(), 3.0);
+  EXPECT_DOUBLE_EQ(b.deviation(), 0.75);
+
+  std::stringstream ss;
+  ss << a - a;
+  EXPECT_EQ(ss.str(), "0. +/- 0.0");
+}
+
+TYPED_TEST(CTOperatorsTest, WrongEpochThrows) {
+  using UD = uncertain::UDoubleCT<TypeParam>;
+  UD a(2.0, 0.5);
+  UD::new_epoch();
+  UD b(1.0, 0.25);
+  EXPECT_ANY_THROW(UD(a + b));
+}
+
+TYPED_TEST(CTOperatorsTest, MoveAndNegateTemporary) {
+  using UD = uncertain::UDoubleCT<TypeParam>;
+  UD a(2.0, 0.5), b(1.0, 0.5);
+
+  UD moved(std::move(UD(a)));
+  EXPECT_EQ(moved.mean(), a.mean());
+  EXPECT_EQ(moved.deviation(), a.deviation());
+
+  UD n = -UD(a);
+  EXPECT_EQ(n.mean(), -2.0);
+  UD zero = n + a;
+  EXPECT_EQ(zero.deviation(), 0.0);
+
+  UD c;
+  c = a - b;
+  c = std::move(n);
+  EXPECT_EQ(c.mean(), -2.0);
+  EXPECT_EQ((++c).mean(), -1.0);
+}
+
+TYPED_TEST(CTOperatorsTest, AutoResultIsIndependentOfOperands) {
+  using UD = uncertain::UDoubleCT<TypeParam>;
+  UD a(2.0, 0.5), b(3.0, 0.25);
+
+  auto e = a * b;
+  static_assert(std::is_same<decltype(e), UD>::value, "arithmetic must yield a UDoubleCT");
+  a *= 3.0;
+  UD r = e;
+  EXPECT_DOUBLE_EQ(r.mean(), 6.0);
+  EXPECT_DOUBLE_EQ(r.deviation(), std::hypot(0.5 * 3.0, 0.25 * 2.0));
+}
+
+TYPED_TEST(CTOperatorsTest, TemporaryOnEitherSide) {
+  using UD = uncertain::UDoubleCT<TypeParam>;
+  UD a(2.0, 0.5), b(4.0, 0.25);
+
+  UD left = UD(a) - b;
+  UD right = a - UD(b);
+  EXPECT_DOUBLE_EQ(left.mean(), right.mean());
+  EXPECT_DOUBLE_EQ(left.deviation(), right.deviation());
+
+  left = UD(a) / b;
+  right = a / UD(b);
+  EXPECT_DOUBLE_EQ(left.mean(), 0.5);
+  EXPECT_DOUBLE_EQ(right.mean(), 0.5);
+  EXPECT_DOUBLE_EQ(left.deviation(), right.deviation());
+  EXPECT_DOUBLE_EQ(left.deviation(), std::hypot(0.5 / 4.0, 0.25 * 2.0 / 16.0));
+}
+
+TEST(AddScaled, SimpleArray) {
+  uncertain::SimpleArray a, b;
+  a.set_element(0, 1.0);
+  b.set_element(0, 2.0);
+  b.set_element(2, 3.0);
+
+  a.add_scaled(b, -0.5);
+  EXPECT_DOUBLE_EQ(a[0], 0.0);
+  EXPECT_DOUBLE_EQ(a[1], 0.0);
+  EXPECT_DOUBLE_EQ(a[2], -1.5);
+  EXPECT_DOUBLE_EQ(a.norm(), 1.5);
+}
+
+TEST(AddScaled, ScaledArray) {
+  uncertain::ScaledArray a, b;
+  a.set_element(0, 1.0);
+  a *= 4.0;
+  b.set_element(1, 2.0);
+  b *= 0.5;
+
+  a.add_scaled(b, 3.0);
+  EXPECT_DOUBLE_EQ(a[0], 4.0);
+  EXPECT_DOUBLE_EQ(a[1], 3.0);
+  EXPECT_DOUBLE_EQ(a.norm(), 5.0);
+
+  // an array scaled to zero takes the other array's components
+  uncertain::ScaledArray z;
+  z.set_element(0, 1.0);
+  z *= 0.0;
+  z.add_scaled(b, 2.0);
+  EXPECT_DOUBLE_EQ(z[1], 2.0);
+  EXPECT_DOUBLE_EQ(z.norm(), 2.0);
+}
+
+TEST(AddScaled, SparseArray) {
+  uncertain::SparseArray a, b;
+  a.set_element(1, 1.0);
+  a.set_element(5, 2.0);
+  b.set_element(3, 4.0);
+  b.set_element(5, 4.0);
+
+  a.add_scaled(b, -0.5);
+  EXPECT_DOUBLE_EQ(a[1], 1.0);
+  EXPECT_DOUBLE_EQ(a[3], -2.0);
+  EXPECT_DOUBLE_EQ(a[5], 0.0);
+  EXPECT_DOUBLE_EQ(a[7], 0.0);
+  EXPECT_DOUBLE_EQ(a.norm(), std::sqrt(5.0));
+}
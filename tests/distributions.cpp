@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <cmath>
+#include <uncertain/distributions.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+using uncertain::DistributionShape;
+
+TEST(Distributions, StandardQuantiles) {
+  std::vector<double> p = {0.125, 0.5, 0.875};
+  uncertain::standard_quantiles(uncertain::Triangular(0.0, 0.5, 1.0).shape(), p.data(), p.size());
+  EXPECT_DOUBLE_EQ(p[0], 0.25);
+  EXPECT_DOUBLE_EQ(p[1], 0.5);
+  EXPECT_DOUBLE_EQ(p[2], 0.75);
+
+  p = {0.5};
+  uncertain::standard_quantiles(uncertain::Lognormal(3.0, 0.7).shape(), p.data(), p.size());
+  EXPECT_DOUBLE_EQ(p[0], 1.0);
+
+  // the far tail keeps its precision
+  p = {0.0, 0.5, 1.0};
+  uncertain::TruncatedNormal tail(0.0, 1.0, 6.0, 7.0);
+  uncertain::standard_quantiles(tail.shape(), p.data(), p.size());
+  EXPECT_NEAR(p[0], 6.0, 1e-12);
+  EXPECT_GT(p[1], 6.0);
+  EXPECT_LT(p[1], 6.2);
+  EXPECT_NEAR(p[2], 7.0, 1e-12);
+
+  EXPECT_THROW(uncertain::Uniform(1.0, 1.0), std::runtime_error);
+  EXPECT_THROW(uncertain::Triangular(0.0, 2.0, 1.0), std::runtime_error);
+  EXPECT_THROW(uncertain::Lognormal(0.0, 0.0), std::runtime_error);
+  EXPECT_THROW(uncertain::TruncatedNormal(0.0, 1.0, 1.0, -1.0), std::runtime_error);
+}
+
+TEST(Distributions, QuantileBasis) {
+  const size_t n = 100;
+  DistributionShape shape = uncertain::Triangular(1.0, 1.5, 3.0).shape();
+  auto basis = uncertain::quantile_basis(shape, n);
+  ASSERT_EQ(basis->size(), n);
+  EXPECT_EQ(uncertain::quantile_basis(shape, n), basis);
+  EXPECT_NE(uncertain::quantile_basis(shape, n + 1), basis);
+
+  // one sample in each slice of equal probability
+  for (size_t i = 0; i + 1 < n; i++) EXPECT_LT((*basis)[i], (*basis)[i + 1]);
+  double mean = 0.0;
+  for (double x : *basis) mean += x;
+  EXPECT_NEAR(mean / n, (0.0 + 0.25 + 1.0) / 3.0, 1e-4);
+
+  // a lognormal basis is the exponential of the Gaussian one
+  auto lognormal = uncertain::quantile_basis(uncertain::Lognormal(0.0, 0.5).shape(), n);
+  double log_mean = 0.0, log_square = 0.0;
+  for (double x : *lognormal) {
+    log_mean += std::log(x);
+    log_square += std::log(x) * std::log(x);
+  }
+  EXPECT_NEAR(log_mean / n, 0.0, 1e-14);
+  EXPECT_NEAR(std::sqrt(log_square / n), 0.5, 1e-14);
+}
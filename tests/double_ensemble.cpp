@@ -1,4 +1,10 @@
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <uncertain/double_ensemble.hpp>
+#include <uncertain/parallel.hpp>
+#include <vector>
 
 #include "test_lib/gtest_print.hpp"
 
@@ -9,6 +15,9 @@ namespace uncertain {
 
 using EnsembleSmall = UDoubleEnsemble<ens_a_size>;
 using EnsembleLarge = UDoubleEnsemble<ens_b_size>;
+using EnsembleSmallHeap = UDoubleEnsemble<ens_a_size, HeapStorage<ens_a_size>>;
+using EnsembleSmallPooled = UDoubleEnsemble<ens_a_size, PooledStorage<ens_a_size>>;
+using EnsembleHuge = UDoubleEnsemble<32768>;
 
 template <>
 SourceSet EnsembleSmall::sources("Small Ensemble");
@@ -28,6 +37,33 @@ std::vector<std::vector<double>> EnsembleLarge::src_ensemble = {};
 template <>
 std::vector<double> EnsembleLarge::gauss_ensemble = {};
 
+template <>
+SourceSet EnsembleSmallHeap::sources("Small Heap Ensemble");
+
+template <>
+std::vector<std::vector<double>> EnsembleSmallHeap::src_ensemble = {};
+
+template <>
+std::vector<double> EnsembleSmallHeap::gauss_ensemble = {};
+
+template <>
+SourceSet EnsembleSmallPooled::sources("Small Pooled Ensemble");
+
+template <>
+std::vector<std::vector<double>> EnsembleSmallPooled::src_ensemble = {};
+
+template <>
+std::vector<double> EnsembleSmallPooled::gauss_ensemble = {};
+
+template <>
+SourceSet EnsembleHuge::sources("Huge Ensemble");
+
+template <>
+std::vector<std::vector<double>> EnsembleHuge::src_ensemble = {};
+
+template <>
+std::vector<double> EnsembleHuge::gauss_ensemble = {};
+
 }  // namespace uncertain
 
 class UDoubleEnsembleTest : public TestBase {
@@ -90,130 +126,155 @@ TEST_F(UDoubleEnsembleTest, UnaryNegateLarge) {
   EXPECT_DOUBLE_EQ(ud2.deviation(), 1.0);
 }
 
+// The sums and quotients of two sources depend on how their samples were
+// shuffled against each other, so they are checked against the covariance
+// of the operands rather than against fixed numbers.
+
 TEST_F(UDoubleEnsembleTest, PlusEquals) {
   uncertain::EnsembleSmall ud(2.0, 1.0);
   uncertain::EnsembleSmall ud2(3.0, 0.5);
+  const double cov = ud.covariance(ud2);
 
   ud += ud2;
-  EXPECT_DOUBLE_EQ(ud.mean(), 5.0);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 1.1530961);
+  EXPECT_NEAR(ud.mean(), 5.0, 1e-14);
+  EXPECT_NEAR(ud.deviation(), std::sqrt(1.0 + 0.25 + 2 * cov), 1e-14);
 }
 
 TEST_F(UDoubleEnsembleTest, PlusEqualsLarge) {
   uncertain::EnsembleLarge ud(2.0, 3.0);
   uncertain::EnsembleLarge ud2(3.0, 4.0);
+  const double cov = ud.covariance(ud2);
 
   ud += ud2;
-  EXPECT_DOUBLE_EQ(ud.mean(), 5.0);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 5.1418414);
+  EXPECT_NEAR(ud.mean(), 5.0, 1e-14);
+  EXPECT_NEAR(ud.deviation(), std::sqrt(9.0 + 16.0 + 2 * cov), 1e-13);
 }
 
 TEST_F(UDoubleEnsembleTest, MinusEquals) {
   uncertain::EnsembleSmall ud(3.0, 1.0);
   uncertain::EnsembleSmall ud2(1.0, 0.5);
+  const double cov = ud.covariance(ud2);
 
   ud -= ud2;
-  EXPECT_DOUBLE_EQ(ud.mean(), 2.0);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 1.1260865);
+  EXPECT_NEAR(ud.mean(), 2.0, 1e-14);
+  EXPECT_NEAR(ud.deviation(), std::sqrt(1.0 + 0.25 - 2 * cov), 1e-14);
 }
 
 TEST_F(UDoubleEnsembleTest, MinusEqualsLarge) {
   uncertain::EnsembleLarge ud(3.0, 3.0);
   uncertain::EnsembleLarge ud2(2.0, 4.0);
+  const double cov = ud.covariance(ud2);
 
   ud -= ud2;
-  EXPECT_DOUBLE_EQ(ud.mean(), 1.0);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 5.1139555);
+  EXPECT_NEAR(ud.mean(), 1.0, 1e-14);
+  EXPECT_NEAR(ud.deviation(), std::sqrt(9.0 + 16.0 - 2 * cov), 1e-13);
 }
 
 TEST_F(UDoubleEnsembleTest, DivEquals) {
   uncertain::EnsembleSmall ud(4.0, 2.0);
-
-  ud /= uncertain::EnsembleSmall(2.0, 1.0);
-  EXPECT_DOUBLE_EQ(ud.mean(), 2.3744812);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 7.9007583);
+  uncertain::EnsembleSmall ud2(2.0, 1.0);
+  // (4 + 2 x) / ud2 has the mean 4 mean(1 / ud2) + 2 cov(x, 1 / ud2)
+  const auto recip = 1.0 / ud2;
+  const double mean = 4.0 * recip.mean() + ud.covariance(recip);
+
+  ud /= ud2;
+  EXPECT_NEAR(ud.mean(), mean, 1e-12);
+  ud *= ud2;
+  EXPECT_NEAR(ud.mean(), 4.0, 1e-12);
+  EXPECT_NEAR(ud.deviation(), 2.0, 1e-12);
 }
 
 TEST_F(UDoubleEnsembleTest, DivEqualsReciprocal) {
+  // a single source is the same basis whatever the shuffle
   auto ud = uncertain::EnsembleSmall(1.0, 0.0);
   ud /= uncertain::EnsembleSmall(2.0, 1.0);
-  EXPECT_DOUBLE_EQ(ud.mean(), 0.63049471);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 1.8518502);
+  EXPECT_NEAR(ud.mean(), 0.62930609, 1e-8);
+  EXPECT_NEAR(ud.deviation(), 1.8505525, 1e-7);
 }
 
 TEST_F(UDoubleEnsembleTest, DivEqualsLarge) {
   uncertain::EnsembleLarge ud(8.0, 6.0);
-
-  ud /= uncertain::EnsembleLarge(2.0, 2.0);
-  EXPECT_DOUBLE_EQ(ud.mean(), 12.625203);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 272.90494);
+  uncertain::EnsembleLarge ud2(2.0, 2.0);
+  const auto recip = 1.0 / ud2;
+  const double mean = 8.0 * recip.mean() + ud.covariance(recip);
+
+  ud /= ud2;
+  EXPECT_NEAR(ud.mean(), mean, 1e-11);
+  ud *= ud2;
+  EXPECT_NEAR(ud.mean(), 8.0, 1e-11);
+  EXPECT_NEAR(ud.deviation(), 6.0, 1e-11);
 }
 
 TEST_F(UDoubleEnsembleTest, DivEqualsLargeReciprocal) {
   uncertain::EnsembleLarge ud(1.0, 0.0);
 
   ud /= uncertain::EnsembleLarge(2.0, 2.0);
-  EXPECT_DOUBLE_EQ(ud.mean(), 0.81952477);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 18.990055);
+  EXPECT_NEAR(ud.mean(), 0.80327316, 1e-8);
+  EXPECT_NEAR(ud.deviation(), 18.595196, 1e-6);
 }
 
 TEST_F(UDoubleEnsembleTest, TimesEquals) {
   uncertain::EnsembleSmall ud(1.0, 0.0);
 
   ud /= uncertain::EnsembleSmall(2.0, 1.0);
-  EXPECT_DOUBLE_EQ(ud.mean(), 0.63049471);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 1.8518502);
+  EXPECT_NEAR(ud.mean(), 0.62930609, 1e-8);
+  EXPECT_NEAR(ud.deviation(), 1.8505525, 1e-7);
 
   auto ud2 = uncertain::EnsembleSmall(2.0, 0.0);
   ud2 /= ud;
-  EXPECT_DOUBLE_EQ(ud2.mean(), 4.0);
-  EXPECT_DOUBLE_EQ(ud2.deviation(), 2.0);
+  EXPECT_NEAR(ud2.mean(), 4.0, 1e-12);
+  EXPECT_NEAR(ud2.deviation(), 2.0, 1e-12);
 }
 
 TEST_F(UDoubleEnsembleTest, TimesEqualsLarge) {
   uncertain::EnsembleLarge ud(1.0, 0.0);
+  uncertain::EnsembleLarge ud3(2.0, 2.0);
 
-  ud /= uncertain::EnsembleLarge(2.0, 2.0);
-  EXPECT_DOUBLE_EQ(ud.mean(), 0.81952477);
-  EXPECT_DOUBLE_EQ(ud.deviation(), 18.990055);
+  ud /= ud3;
+  EXPECT_NEAR(ud.mean(), 0.80327316, 1e-8);
+  EXPECT_NEAR(ud.deviation(), 18.595196, 1e-6);
 
+  // (4 + 5 x) / ud is (4 + 5 x) ud3, whose mean is 8 + 5 cov(x, ud3)
   auto ud2 = uncertain::EnsembleLarge(4.0, 5.0);
+  const double mean = 8.0 + ud2.covariance(ud3);
   ud2 /= ud;
-  EXPECT_DOUBLE_EQ(ud2.mean(), 7.330265);
-  EXPECT_DOUBLE_EQ(ud2.deviation(), 15.943852);
-  //  EXPECT_DOUBLE_EQ(ud2.deviation(), 6.0);
+  EXPECT_NEAR(ud2.mean(), mean, 1e-10);
 }
 
 TEST_F(UDoubleEnsembleTest, Ceiling) {
   uncertain::EnsembleLarge ud(2.5, 1.0);
   auto ud2 = ceil(ud);
-  EXPECT_DOUBLE_EQ(ud2.mean(), 3.0);
-  EXPECT_DOUBLE_EQ(ud2.deviation(), 1.0364453);
+  EXPECT_NEAR(ud2.mean(), 3.0, 1e-14);
+  EXPECT_NEAR(ud2.deviation(), 1.0364452, 1e-7);
 }
 
 TEST_F(UDoubleEnsembleTest, SqrtSmall) {
   uncertain::EnsembleSmall ud(64.0, 1.0);
 
   auto ud2 = sqrt(ud);
-  EXPECT_DOUBLE_EQ(ud2.mean(), 7.9997559);
-  EXPECT_DOUBLE_EQ(ud2.deviation(), 0.062506683);
+  EXPECT_NEAR(ud2.mean(), 7.9997558, 1e-7);
+  EXPECT_NEAR(ud2.deviation(), 0.062506679, 1e-9);
 }
 
 TEST_F(UDoubleEnsembleTest, SqrtLarge) {
   uncertain::EnsembleLarge ud(64.0, 2.0);
 
   auto ud2 = sqrt(ud);
-  EXPECT_DOUBLE_EQ(ud2.mean(), 7.9990225);
-  EXPECT_DOUBLE_EQ(ud2.deviation(), 0.12505354);
+  EXPECT_NEAR(ud2.mean(), 7.9990225, 1e-7);
+  EXPECT_NEAR(ud2.deviation(), 0.12505353, 1e-8);
 }
 
 TEST_F(UDoubleEnsembleTest, PowSmall) {
   uncertain::EnsembleSmall ud(8.0, 1.0);
   uncertain::EnsembleSmall ud2(2.0, 0.1);
 
+  // log(ud^ud2) is ud2 log(ud), sample by sample
   auto ud3 = pow(ud, ud2);
-  EXPECT_DOUBLE_EQ(ud3.mean(), 66.276054);
-  EXPECT_DOUBLE_EQ(ud3.deviation(), 21.70063);
+  auto expected = ud2 * log(ud);
+  auto log_pow = log(ud3);
+  EXPECT_NEAR(log_pow.mean(), expected.mean(), 1e-12);
+  EXPECT_NEAR(log_pow.deviation(), expected.deviation(), 1e-12);
+  EXPECT_GT(ud3.mean(), 64.0);
 }
 
 TEST_F(UDoubleEnsembleTest, PowLarge) {
@@ -221,6 +282,311 @@ TEST_F(UDoubleEnsembleTest, PowLarge) {
   uncertain::EnsembleLarge ud2(2.0, 0.1);
 
   auto ud3 = pow(ud, ud2);
-  EXPECT_DOUBLE_EQ(ud3.mean(), 66.119255);
-  EXPECT_DOUBLE_EQ(ud3.deviation(), 21.194429);
+  auto expected = ud2 * log(ud);
+  auto log_pow = log(ud3);
+  EXPECT_NEAR(log_pow.mean(), expected.mean(), 1e-12);
+  EXPECT_NEAR(log_pow.deviation(), expected.deviation(), 1e-12);
+  EXPECT_GT(ud3.mean(), 64.0);
+}
+
+static std::vector<double> ramp(double offset) {
+  std::vector<double> retval(ens_a_size);
+  for (size_t i = 0; i < ens_a_size; i++) retval[i] = offset + double(i % 7) - 3.0;
+  return retval;
+}
+
+// the features that do not depend on the storage, for each kind of storage
+template <class T>
+class UDoubleEnsembleStorage : public TestBase {};
+
+using EnsembleTypes = ::testing::Types<uncertain::EnsembleSmall, uncertain::EnsembleSmallHeap,
+                                       uncertain::EnsembleSmallPooled>;
+TYPED_TEST_SUITE(UDoubleEnsembleStorage, EnsembleTypes);
+
+TYPED_TEST(UDoubleEnsembleStorage, Moments) {
+  // a large offset makes naive sums lose the spread
+  std::vector<double> samples = ramp(1e8);
+  long double mean = 0.0;
+  for (double s : samples) mean += s;
+  mean /= ens_a_size;
+  long double sums[6] = {0.0};
+  for (double s : samples) {
+    long double diff = s - mean, power = 1.0;
+    for (size_t k = 0; k < 6; k++, power *= diff) sums[k] += power;
+  }
+  double var = sums[2] / ens_a_size, sigma = std::sqrt(var);
+
+  TypeParam a(samples);
+  EXPECT_DOUBLE_EQ(a.mean(), double(mean));
+  EXPECT_DOUBLE_EQ(a.deviation(), sigma);
+  double m, s, skew, kurtosis, m5;
+  TypeParam::moments(samples, m, s, skew, kurtosis, m5);
+  EXPECT_DOUBLE_EQ(m, double(mean));
+  EXPECT_DOUBLE_EQ(s, sigma);
+  EXPECT_NEAR(skew, double(sums[3] / (var * sigma * ens_a_size)), 1e-12);
+  EXPECT_NEAR(kurtosis, double(sums[4] / (var * var * ens_a_size) - 3), 1e-12);
+  EXPECT_NEAR(m5, double(sums[5] / (var * var * sigma * ens_a_size)), 1e-12);
+
+  // the basis of new values has the moments of a normal distribution
+  TypeParam b(2.0, 0.5);
+  TypeParam::moments(TypeParam::gauss_ensemble, m, s, skew, kurtosis, m5);
+  EXPECT_NEAR(m, 0.0, 1e-14);
+  EXPECT_NEAR(s, 1.0, 1e-14);
+  EXPECT_NEAR(skew, 0.0, 1e-12);
+  EXPECT_NEAR(kurtosis, 0.0, 1e-6);
+  EXPECT_NEAR(m5, 0.0, 1e-12);
+}
+
+TYPED_TEST(UDoubleEnsembleStorage, Stats) {
+  TypeParam a(ramp(1e8));
+  double m, s, skew, kurtosis, m5;
+  TypeParam::moments(ramp(1e8), m, s, skew, kurtosis, m5);
+  uncertain::EnsembleStats stats = a.stats();
+  EXPECT_DOUBLE_EQ(stats.mean, m);
+  EXPECT_DOUBLE_EQ(stats.deviation, s);
+  EXPECT_NEAR(stats.skew, skew, 1e-12);
+  EXPECT_NEAR(stats.kurtosis, kurtosis, 1e-12);
+  EXPECT_NEAR(stats.m5, m5, 1e-12);
+  EXPECT_DOUBLE_EQ(a.deviation(), s);
+}
+
+TYPED_TEST(UDoubleEnsembleStorage, CorrelationWithOffset) {
+  std::vector<double> x = ramp(1.0), y(ens_a_size);
+  for (size_t i = 0; i < ens_a_size; i++) y[i] = double(i % 5) * x[(i + 3) % ens_a_size];
+  TypeParam a(x), b(y);
+  for (size_t offset : {0, 1, 3, 127, 128, 129}) {
+    double mean_a = a.mean(), mean_b = b.mean();
+    double saa = 0.0, sbb = 0.0, sab = 0.0;
+    for (size_t i = 0; i < ens_a_size; i++) {
+      double da = x[i] - mean_a, db = y[(i + offset) % ens_a_size] - mean_b;
+      saa += da * da;
+      sbb += db * db;
+      sab += da * db;
+    }
+    double expected = sab / std::sqrt(saa * sbb);
+    EXPECT_NEAR(a.correlation(b, offset), expected, 1e-14);
+    EXPECT_NEAR(a.correlation(y, offset), expected, 1e-14);
+  }
+  EXPECT_NEAR(a.correlation(a), 1.0, 1e-14);
+  EXPECT_EQ(a.correlation(TypeParam(3.0)), 0.0);
+
+  // samples must match the ensemble one for one
+  EXPECT_THROW(a.correlation(std::vector<double>{}), std::runtime_error);
+  EXPECT_THROW(a.correlation(std::vector<double>(ens_a_size + 1)), std::runtime_error);
+  EXPECT_THROW(a.lag_correlations(std::vector<double>(ens_a_size - 1)), std::runtime_error);
+
+  // as are values of another epoch
+  TypeParam::new_epoch();
+  TypeParam c(1.0, 0.5);
+  EXPECT_THROW(a.correlation(c), std::runtime_error);
+  EXPECT_THROW(a.covariance(c), std::runtime_error);
+  EXPECT_THROW(atan2(a, c), std::runtime_error);
+  EXPECT_THROW(TypeParam::func2([](double x, double y) { return x * y; }, a, c),
+               std::runtime_error);
+}
+
+TYPED_TEST(UDoubleEnsembleStorage, CachedStatsFollowChanges) {
+  TypeParam a(ramp(10.0));
+  double mean = a.mean(), deviation = a.deviation();
+  EXPECT_EQ(a.stats().mean, mean);
+
+  a += 1.0;
+  EXPECT_DOUBLE_EQ(a.mean(), mean + 1.0);
+  a *= 2.0;
+  EXPECT_DOUBLE_EQ(a.deviation(), 2.0 * deviation);
+  a = -std::move(a);
+  EXPECT_DOUBLE_EQ(a.mean(), -2.0 * (mean + 1.0));
+  a.shuffle();
+  EXPECT_DOUBLE_EQ(a.mean(), -2.0 * (mean + 1.0));
+
+  // the copy keeps the statistics, the changed original does not
+  TypeParam b(a);
+  a = fabs(a);
+  EXPECT_DOUBLE_EQ(a.mean(), 2.0 * (mean + 1.0));
+  EXPECT_DOUBLE_EQ(b.mean(), -2.0 * (mean + 1.0));
+
+  // modf() reads the mean before it changes the samples
+  double integral;
+  TypeParam c = modf(b, &integral);
+  EXPECT_LT(std::fabs(c.mean()), 1.0);
+}
+
+TYPED_TEST(UDoubleEnsembleStorage, ConcurrentStats) {
+  TypeParam a(ramp(10.0));
+  uncertain::EnsembleStats expected = TypeParam(ramp(10.0)).stats();
+  std::vector<uncertain::EnsembleStats> results(4);
+  std::vector<std::thread> threads;
+  for (auto &result : results) threads.emplace_back([&a, &result] { result = a.stats(); });
+  for (auto &thread : threads) thread.join();
+  for (const auto &result : results) {
+    EXPECT_EQ(result.mean, expected.mean);
+    EXPECT_EQ(result.deviation, expected.deviation);
+  }
+}
+
+TYPED_TEST(UDoubleEnsembleStorage, ShufflesFollowSeedAndSource) {
+  TypeParam::set_seed(1234);
+  TypeParam::new_epoch();
+  TypeParam a(0.0, 1.0), b(0.0, 1.0);
+  std::vector<std::vector<double>> first = {TypeParam::source_samples(0),
+                                            TypeParam::source_samples(1)};
+  EXPECT_NE(first[0], first[1]);
+
+  // the same sources of a new epoch get the same shuffles, even when they
+  // are made on another thread
+  TypeParam::new_epoch();
+  std::thread([] { TypeParam c(0.0, 1.0), d(0.0, 1.0); }).join();
+  EXPECT_EQ(TypeParam::source_samples(0), first[0]);
+  EXPECT_EQ(TypeParam::source_samples(1), first[1]);
+
+  TypeParam::set_seed(4321);
+  TypeParam::new_epoch();
+  TypeParam e(0.0, 1.0);
+  EXPECT_NE(TypeParam::source_samples(0), first[0]);
+  TypeParam::set_seed(0);
+}
+
+TEST(UDoubleEnsemble, SamplingModes) {
+  using uncertain::EnsembleSampling;
+  for (auto sampling : {EnsembleSampling::latin_hypercube, EnsembleSampling::sobol}) {
+    uncertain::EnsembleLarge::set_sampling(sampling);
+    uncertain::EnsembleLarge::new_epoch();
+    uncertain::EnsembleLarge a(1.0, 0.5), b(2.0, 0.25);
+    EXPECT_NEAR(a.mean(), 1.0, 1e-3);
+    EXPECT_NEAR(a.deviation(), 0.5, 1e-2);
+    EXPECT_NEAR(b.mean(), 2.0, 1e-3);
+    EXPECT_NEAR(b.deviation(), 0.25, 1e-2);
+    // sources 0 and 1 take the first two Sobol dimensions, the best paired
+    double spurious = sampling == EnsembleSampling::sobol ? 0.01 : 0.1;
+    EXPECT_LT(std::fabs(a.correlation(b)), spurious);
+    // the samples follow from the seed and the source number
+    auto first = uncertain::EnsembleLarge::source_samples(1);
+    uncertain::EnsembleLarge::new_epoch();
+    uncertain::EnsembleLarge c(1.0, 0.5), d(2.0, 0.25);
+    EXPECT_EQ(uncertain::EnsembleLarge::source_samples(1), first);
+  }
+  uncertain::EnsembleLarge::set_sampling(EnsembleSampling::shuffled_basis);
+}
+
+TEST(UDoubleEnsemble, Distributions) {
+  using uncertain::EnsembleLarge;
+  EnsembleLarge::new_epoch();
+  EnsembleLarge a(uncertain::Uniform(2.0, 4.0)), b(uncertain::Uniform(2.0, 4.0), "b");
+  EXPECT_NEAR(a.mean(), 3.0, 1e-12);
+  EXPECT_NEAR(a.deviation(), 2.0 / std::sqrt(12.0), 1e-5);
+  EXPECT_NE(EnsembleLarge::source_samples(0), EnsembleLarge::source_samples(1));
+  EXPECT_LT(std::fabs(a.correlation(b)), 0.1);
+
+  EnsembleLarge c(uncertain::Lognormal(0.5, 0.25));
+  EXPECT_NEAR(c.mean(), std::exp(0.5 + 0.25 * 0.25 / 2), 1e-4);
+  EXPECT_EQ(EnsembleLarge::num_tracked_sources(), 3u);
+
+  EnsembleLarge::set_sampling(uncertain::EnsembleSampling::sobol);
+  EnsembleLarge d(uncertain::TruncatedNormal(1.0, 2.0, 0.0, 1.0));
+  EXPECT_GT(d.mean(), 0.5);
+  EXPECT_LT(d.mean(), 1.0);
+  EnsembleLarge::set_sampling(uncertain::EnsembleSampling::shuffled_basis);
+}
+
+TYPED_TEST(UDoubleEnsembleStorage, SourcesAreMadeAgain) {
+  TypeParam::new_epoch();
+  TypeParam a(1.0, 0.5), b(uncertain::Triangular(0.0, 0.2, 1.0)), c(ramp(2.0));
+  TypeParam::set_sampling(uncertain::EnsembleSampling::latin_hypercube);
+  TypeParam d(3.0, 0.1);
+  TypeParam::set_sampling(uncertain::EnsembleSampling::shuffled_basis);
+
+  // only the given samples are kept whole
+  ASSERT_EQ(TypeParam::num_tracked_sources(), 4u);
+  EXPECT_TRUE(TypeParam::src_ensemble[0].empty());
+  EXPECT_EQ(TypeParam::src_ensemble[2], ramp(2.0));
+  const TypeParam *values[] = {&a, &b, &c, &d};
+  for (size_t i = 0; i < 4; i++) {
+    std::vector<double> source = TypeParam::source_samples(i);
+    ASSERT_EQ(source.size(), ens_a_size);
+    double m, sigma, skew, kurtosis, m5;
+    TypeParam::moments(source, m, sigma, skew, kurtosis, m5);
+    EXPECT_NEAR(values[i]->correlation(source), 1.0, 1e-12);
+    EXPECT_DOUBLE_EQ(m, values[i]->mean());
+    EXPECT_DOUBLE_EQ(sigma, values[i]->deviation());
+  }
+  EXPECT_TRUE(TypeParam::source_samples(4).empty());
+
+  std::ostringstream os;
+  (a + b).print_uncertain_sources(os);
+  EXPECT_NE(os.str().find("anon triangular(0, 0.2, 1)"), std::string::npos);
+
+  TypeParam::set_source_tracking(false);
+  TypeParam e(1.0, 0.5), f(ramp(1.0));
+  EXPECT_EQ(TypeParam::num_tracked_sources(), 4u);
+  TypeParam::set_source_tracking(true);
+}
+
+TEST(UDoubleEnsemble, AttributeSources) {
+  using uncertain::EnsembleLarge;
+  EnsembleLarge::new_epoch();
+  std::vector<EnsembleLarge> inputs;
+  for (int i = 0; i < 11; i++)
+    inputs.emplace_back(1.0, 0.1 * (i + 1), "input " + std::to_string(i));
+  EnsembleLarge sum;
+  for (const auto &input : inputs) sum += input;
+
+  size_t original_threads = uncertain::get_num_threads();
+  for (size_t threads : {1, 4}) {
+    uncertain::set_num_threads(threads);
+    uncertain::EnsembleAttribution attribution = sum.attribute_sources();
+    ASSERT_EQ(attribution.sources.size(), inputs.size());
+    double total = 0.0;
+    for (size_t i = 0; i < inputs.size(); i++) {
+      const auto &source = attribution.sources[i];
+      EXPECT_EQ(source.number, i);
+      EXPECT_EQ(source.name, "input " + std::to_string(i));
+      EXPECT_NEAR(source.correlation, sum.correlation(inputs[i]), 1e-12);
+      EXPECT_DOUBLE_EQ(source.portion, source.correlation * source.correlation);
+      total += source.portion;
+    }
+    EXPECT_NEAR(attribution.other, 1.0 - total, 1e-12);
+    // only the spurious correlations between the inputs are left over
+    EXPECT_LT(std::fabs(attribution.other), 0.2);
+  }
+  uncertain::set_num_threads(original_threads);
+
+  EXPECT_TRUE(EnsembleLarge(2.0).attribute_sources().sources.empty());
+}
+
+static double halve(double x) { return x / 2; }
+
+TEST(UDoubleEnsemble, ParallelLoops) {
+  using uncertain::EnsembleHuge;
+  EnsembleHuge::new_epoch();
+  const size_t n = 32768;
+  std::vector<double> u(n), v(n);
+  for (size_t i = 0; i < n; i++) {
+    u[i] = std::sin(0.37 * i) + 2.0;
+    v[i] = std::cos(0.11 * i) + 3.0;
+  }
+  EnsembleHuge a(u), b(v), c(uncertain::Uniform(0.0, 1.0));
+  auto compute = [&] {
+    EnsembleHuge d = sqrt(a) / b - 2.0 * c + Invoke(halve, a);
+    d = EnsembleHuge::func2([](double x, double y) { return x * y; }, d, exp(-b));
+    return ldexp(EnsembleHuge::func1([](double x) { return x + 1.0; }, d), 2);
+  };
+  const std::vector<double> probabilities = {0.0, 0.1, 0.5, 0.9, 1.0};
+
+  EXPECT_EQ(EnsembleHuge::get_parallel_threshold(), uncertain::kEnsembleSerial);
+  EnsembleHuge serial = compute();
+  size_t original_threads = uncertain::get_num_threads();
+  EnsembleHuge::set_parallel_threshold(n);
+  uncertain::set_num_threads(1);
+  EnsembleHuge one = compute();
+  uncertain::set_num_threads(4);
+  EnsembleHuge four = compute();
+  uncertain::set_num_threads(original_threads);
+  EnsembleHuge::set_parallel_threshold(uncertain::kEnsembleSerial);
+
+  // the samples are the same; the moments are summed by blocks
+  EXPECT_EQ(four.quantiles(probabilities), serial.quantiles(probabilities));
+  EXPECT_NEAR(four.mean(), serial.mean(), 1e-12 * std::fabs(serial.mean()));
+  EXPECT_NEAR(four.deviation(), serial.deviation(), 1e-12 * serial.deviation());
+  EXPECT_EQ(four.stats().mean, one.stats().mean);
+  EXPECT_EQ(four.stats().m5, one.stats().m5);
 }
@@ -0,0 +1,111 @@
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <uncertain/dynamic_ensemble.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+using uncertain::UDoubleDynamicEnsemble;
+
+TEST(DynamicEnsemble, SizeIsChosenPerEpoch) {
+  for (size_t n : {64u, 1000u, 4096u}) {
+    UDoubleDynamicEnsemble::new_epoch(n);
+    EXPECT_EQ(UDoubleDynamicEnsemble::get_ensemble_size(), n);
+    UDoubleDynamicEnsemble a(2.0, 0.5), b(1.0), c(uncertain::Uniform(0.0, 1.0));
+    EXPECT_EQ(a.size(), n);
+    EXPECT_EQ(b.size(), n);
+    EXPECT_EQ(c.size(), n);
+    EXPECT_NEAR(a.mean(), 2.0, 1e-12);
+    EXPECT_NEAR(a.deviation(), 0.5, 1e-12);
+    EXPECT_NEAR(c.mean(), 0.5, 1e-12);
+  }
+  UDoubleDynamicEnsemble a(1.0, 0.1);
+  UDoubleDynamicEnsemble::new_epoch(256);
+  UDoubleDynamicEnsemble b(1.0, 0.1);
+  EXPECT_THROW(a + b, std::runtime_error);
+  EXPECT_THROW(pow(a, b), std::runtime_error);
+  EXPECT_THROW(a.correlation(b), std::runtime_error);
+  EXPECT_THROW(b.lag_correlations(std::vector<double>(100)), std::runtime_error);
+  EXPECT_THROW(UDoubleDynamicEnsemble(std::vector<double>(100, 1.0)), std::runtime_error);
+  EXPECT_THROW(UDoubleDynamicEnsemble::new_epoch(1), std::runtime_error);
+}
+
+TEST(DynamicEnsemble, MatchesFixedSize) {
+  using Fixed = uncertain::UDoubleEnsemble<1024>;
+  Fixed::new_epoch();
+  UDoubleDynamicEnsemble::new_epoch(1024);
+  Fixed::set_seed(11);
+  UDoubleDynamicEnsemble::set_seed(11);
+
+  Fixed fa(1.0, 0.1), fb(uncertain::Lognormal(0.0, 0.5));
+  UDoubleDynamicEnsemble da(1.0, 0.1), db(uncertain::Lognormal(0.0, 0.5));
+  Fixed fr = sin(fa) * fb + 2.0 / fa - exp(fb);
+  UDoubleDynamicEnsemble dr = sin(da) * db + 2.0 / da - exp(db);
+  EXPECT_DOUBLE_EQ(dr.mean(), fr.mean());
+  EXPECT_DOUBLE_EQ(dr.deviation(), fr.deviation());
+  EXPECT_DOUBLE_EQ(dr.stats().kurtosis, fr.stats().kurtosis);
+  EXPECT_EQ(dr.quantiles({0.1, 0.9}), fr.quantiles({0.1, 0.9}));
+
+  std::ostringstream fixed_text, dynamic_text;
+  fixed_text << fr;
+  fr.print_uncertain_sources(fixed_text);
+  fr.print_histogram(fixed_text);
+  dynamic_text << dr;
+  dr.print_uncertain_sources(dynamic_text);
+  dr.print_histogram(dynamic_text);
+  EXPECT_EQ(dynamic_text.str(), fixed_text.str());
+  EXPECT_EQ(dr.credible_interval(), fr.credible_interval());
+  EXPECT_EQ(dr.correlation(db, 5), fr.correlation(fb, 5));
+  EXPECT_EQ(dr.covariance(db), fr.covariance(fb));
+
+  Fixed::set_seed(0);
+  UDoubleDynamicEnsemble::set_seed(0);
+}
+
+TEST(DynamicEnsemble, Sources) {
+  UDoubleDynamicEnsemble::new_epoch(128);
+  UDoubleDynamicEnsemble a(1.0, 0.5, "a");
+  std::vector<double> ramp(128);
+  for (size_t i = 0; i < ramp.size(); i++) ramp[i] = i;
+  UDoubleDynamicEnsemble b(ramp, "b");
+  UDoubleDynamicEnsemble c = UDoubleDynamicEnsemble::func2(
+      [](double x, double y) { return x + 0.01 * y; }, a, b);
+
+  ASSERT_EQ(UDoubleDynamicEnsemble::num_tracked_sources(), 2u);
+  EXPECT_EQ(UDoubleDynamicEnsemble::get_source_name(1), "b");
+  EXPECT_EQ(UDoubleDynamicEnsemble::source_samples(1), ramp);
+  EXPECT_NEAR(a.correlation(UDoubleDynamicEnsemble::source_samples(0)), 1.0, 1e-12);
+
+  uncertain::EnsembleAttribution attribution = c.attribute_sources();
+  ASSERT_EQ(attribution.sources.size(), 2u);
+  EXPECT_NEAR(attribution.sources[0].correlation, c.correlation(a), 1e-12);
+  EXPECT_NEAR(attribution.sources[1].correlation, c.correlation(ramp), 1e-12);
+
+  std::vector<double> r = c.lag_correlations(a);
+  for (size_t offset = 0; offset < 128; offset += 9)
+    EXPECT_NEAR(r[offset], c.correlation(a, offset), 1e-12);
+  EXPECT_NEAR(a.covariance(a), a.deviation() * a.deviation(), 1e-12);
+}
+
+TEST(DynamicEnsemble, ParallelLoops) {
+  const size_t n = 40000;
+  UDoubleDynamicEnsemble::new_epoch(n);
+  UDoubleDynamicEnsemble a(2.0, 0.5), b(uncertain::Triangular(1.0, 2.0, 4.0));
+  auto compute = [&] {
+    UDoubleDynamicEnsemble c = log(a * b + 10.0) - 1.0 / b;
+    return UDoubleDynamicEnsemble::func2([](double x, double y) { return x - y * y; }, c, a);
+  };
+  UDoubleDynamicEnsemble serial = compute();
+  size_t original_threads = uncertain::get_num_threads();
+  UDoubleDynamicEnsemble::set_parallel_threshold(n);
+  uncertain::set_num_threads(3);
+  UDoubleDynamicEnsemble parallel = compute();
+  uncertain::set_num_threads(original_threads);
+  UDoubleDynamicEnsemble::set_parallel_threshold(uncertain::kEnsembleSerial);
+
+  EXPECT_EQ(std::vector<double>(parallel.data(), parallel.data() + n),
+            std::vector<double>(serial.data(), serial.data() + n));
+  EXPECT_NEAR(parallel.deviation(), serial.deviation(), 1e-12 * serial.deviation());
+  EXPECT_NEAR(parallel.stats().skew, serial.stats().skew, 1e-10);
+}
@@ -0,0 +1,91 @@
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <uncertain/ensemble_basis.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+namespace fs = std::filesystem;
+
+// a fresh directory under the system temporary directory
+static fs::path temporary_dir() {
+  fs::path dir = fs::temp_directory_path() /
+                 ("uncertain_basis_test_" + std::to_string(std::random_device{}()));
+  fs::create_directories(dir);
+  return dir;
+}
+
+TEST(EnsembleBasis, LargeBasisHasNormalMoments) {
+  // the kurtosis correction must stop once the kurtosis is down to rounding
+  std::vector<double> basis = uncertain::make_gauss_basis(1024);
+  double m, s, skew, kurtosis, m5;
+  uncertain::ensemble_moments(basis.data(), basis.size(), m, s, skew, kurtosis, m5);
+  EXPECT_NEAR(m, 0.0, 1e-14);
+  EXPECT_NEAR(s, 1.0, 1e-14);
+  EXPECT_NEAR(skew, 0.0, 1e-12);
+  EXPECT_NEAR(kurtosis, 0.0, 1e-12);
+}
+
+TEST(EnsembleBasis, TablesMatchComputed) {
+  for (size_t n : {64, 1024}) {
+    const double *table = uncertain::precomputed_gauss_basis(n);
+    ASSERT_NE(table, nullptr) << n;
+    auto basis = uncertain::compute_gauss_basis(n);
+    for (size_t i = 0; i < n; i++) EXPECT_DOUBLE_EQ(table[i], basis[i]) << n << " " << i;
+  }
+  EXPECT_EQ(uncertain::precomputed_gauss_basis(100), nullptr);
+}
+
+TEST(EnsembleBasis, CacheFileRoundTrip) {
+  fs::path dir = temporary_dir();
+  auto basis = uncertain::compute_gauss_basis(101);
+  std::string path = uncertain::gauss_basis_cache_file(dir.string(), basis.size());
+
+  std::vector<double> read;
+  EXPECT_FALSE(uncertain::read_gauss_basis_file(path, basis.size(), read));
+  ASSERT_TRUE(uncertain::write_gauss_basis_file(path, basis));
+  ASSERT_TRUE(uncertain::read_gauss_basis_file(path, basis.size(), read));
+  EXPECT_EQ(read, basis);
+  EXPECT_FALSE(uncertain::read_gauss_basis_file(path, basis.size() + 1, read));
+
+  // a damaged sample fails the checksum
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(40);
+    file.put(0x55);
+  }
+  EXPECT_FALSE(uncertain::read_gauss_basis_file(path, basis.size(), read));
+
+  // so does a truncated file
+  ASSERT_TRUE(uncertain::write_gauss_basis_file(path, basis));
+  fs::resize_file(path, fs::file_size(path) - 4);
+  EXPECT_FALSE(uncertain::read_gauss_basis_file(path, basis.size(), read));
+
+  fs::remove_all(dir);
+}
+
+TEST(EnsembleBasis, MakeFillsCache) {
+  fs::path dir = temporary_dir();
+  uncertain::set_gauss_basis_cache_dir(dir.string());
+  EXPECT_EQ(uncertain::gauss_basis_cache_dir(), dir.string());
+
+  const size_t n = 100;
+  auto basis = uncertain::make_gauss_basis(n);
+  EXPECT_EQ(basis, uncertain::compute_gauss_basis(n));
+  std::string path = uncertain::gauss_basis_cache_file(dir.string(), n);
+  EXPECT_TRUE(fs::exists(path));
+  EXPECT_EQ(uncertain::make_gauss_basis(n), basis);
+
+  // sizes in the tables never touch the disk
+  uncertain::make_gauss_basis(64);
+  EXPECT_FALSE(fs::exists(uncertain::gauss_basis_cache_file(dir.string(), 64)));
+
+  // and with caching disabled nothing is written
+  uncertain::set_gauss_basis_cache_dir("");
+  EXPECT_EQ(uncertain::make_gauss_basis(102).size(), 102u);
+  EXPECT_FALSE(fs::exists(uncertain::gauss_basis_cache_file(dir.string(), 102)));
+
+  fs::remove_all(dir);
+}
@@ -0,0 +1,90 @@
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <uncertain/ensemble_refinement.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+using uncertain::UDoubleDynamicEnsemble;
+
+TEST(EnsembleRefinement, ReplicateErrors) {
+  std::vector<uncertain::EnsembleStats> runs(3);
+  runs[0].mean = 1.0;
+  runs[1].mean = 2.0;
+  runs[2].mean = 3.0;
+  for (auto &run : runs) run.deviation = 0.5;
+  double mean_error, deviation_error;
+  uncertain::replicate_errors(runs, mean_error, deviation_error);
+  EXPECT_DOUBLE_EQ(mean_error, 1.0);
+  EXPECT_EQ(deviation_error, 0.0);
+
+  runs.resize(1);
+  uncertain::replicate_errors(runs, mean_error, deviation_error);
+  EXPECT_EQ(mean_error, 0.0);
+}
+
+TEST(EnsembleRefinement, LinearConvergesAtInitialSize) {
+  auto compute = [] {
+    UDoubleDynamicEnsemble x(1.0, 0.1);
+    return 2.0 * x + 1.0;
+  };
+  uint64_t seed = UDoubleDynamicEnsemble::get_seed();
+  uncertain::RefinementResult result = uncertain::refine_ensemble_size(compute);
+  EXPECT_TRUE(result.converged);
+  ASSERT_EQ(result.stages.size(), 1u);
+  EXPECT_EQ(result.stages[0].ensemble_size, 256u);
+  EXPECT_EQ(result.value.size(), 256u);
+  EXPECT_NEAR(result.value.mean(), 3.0, 1e-12);
+  EXPECT_NEAR(result.value.deviation(), 0.2, 1e-12);
+  EXPECT_GE(result.stages[0].seconds, 0.0);
+  EXPECT_EQ(UDoubleDynamicEnsemble::get_seed(), seed);
+
+  std::ostringstream os;
+  result.print(os);
+  EXPECT_NE(os.str().find("     256: "), std::string::npos);
+  EXPECT_NE(os.str().find("converged"), std::string::npos);
+}
+
+TEST(EnsembleRefinement, StopsWhenPreciseEnough) {
+  // the product of two sources is not stratified by either one alone
+  auto compute = [] {
+    UDoubleDynamicEnsemble x(1.0, 0.5), y(2.0, 1.0);
+    return x * y;
+  };
+  uncertain::RefinementResult result = uncertain::refine_ensemble_size(compute);
+  EXPECT_TRUE(result.converged);
+  ASSERT_GT(result.stages.size(), 1u);
+  const uncertain::RefinementStage &last = result.stages.back();
+  EXPECT_EQ(result.value.size(), last.ensemble_size);
+  EXPECT_LE(last.mean_error, 0.01 * last.stats.deviation);
+  EXPECT_LE(last.deviation_error, 0.01 * last.stats.deviation);
+  const uncertain::RefinementStage &first = result.stages.front();
+  EXPECT_TRUE(first.mean_error > 0.01 * first.stats.deviation ||
+              first.deviation_error > 0.01 * first.stats.deviation);
+  EXPECT_NEAR(result.value.mean(), 2.0, 0.05);
+}
+
+TEST(EnsembleRefinement, StopsAtMaxSize) {
+  auto compute = [] {
+    UDoubleDynamicEnsemble x(1.0, 0.5), y(uncertain::Uniform(0.0, 1.0));
+    return exp(x) * y;
+  };
+  uncertain::RefinementOptions options;
+  options.initial_size = 100;
+  options.max_size = 1000;
+  options.growth = 3;
+  options.mean_tolerance = 0.001;
+  uncertain::RefinementResult result = uncertain::refine_ensemble_size(compute, options);
+  EXPECT_FALSE(result.converged);
+  std::vector<size_t> sizes;
+  for (const auto &stage : result.stages) sizes.push_back(stage.ensemble_size);
+  EXPECT_EQ(sizes, (std::vector<size_t>{100, 300, 900}));
+  EXPECT_EQ(UDoubleDynamicEnsemble::get_ensemble_size(), 900u);
+
+  options.growth = 1;
+  EXPECT_THROW(uncertain::refine_ensemble_size(compute, options), std::runtime_error);
+  options.growth = 2;
+  options.replicates = 1;
+  EXPECT_THROW(uncertain::refine_ensemble_size(compute, options), std::runtime_error);
+}
@@ -0,0 +1,217 @@
+#include <uncertain/double_ensemble.hpp>
+
+#include "test_lib/gtest_print.hpp"
+
+static constexpr size_t ens_size = 64u;
+
+namespace uncertain {
+
+using EnsembleHeap = UDoubleEnsemble<ens_size, HeapStorage<ens_size>>;
+using EnsembleInline = UDoubleEnsemble<ens_size, InlineStorage<ens_size>>;
+using EnsemblePooled = UDoubleEnsemble<ens_size, PooledStorage<ens_size>>;
+
+template <>
+SourceSet EnsembleHeap::sources("Heap Ensemble");
+
+template <>
+std::vector<std::vector<double>> EnsembleHeap::src_ensemble = {};
+
+template <>
+std::vector<double> EnsembleHeap::gauss_ensemble = {};
+
+template <>
+SourceSet EnsembleInline::sources("Inline Ensemble");
+
+template <>
+std::vector<std::vector<double>> EnsembleInline::src_ensemble = {};
+
+template <>
+std::vector<double> EnsembleInline::gauss_ensemble = {};
+
+template <>
+SourceSet EnsemblePooled::sources("Pooled Ensemble");
+
+template <>
+std::vector<std::vector<double>> EnsemblePooled::src_ensemble = {};
+
+template <>
+std::vector<double> EnsemblePooled::gauss_ensemble = {};
+
+}  // namespace uncertain
+
+static std::vector<double> ramp(double offset) {
+  std::vector<double> retval(ens_size);
+  for (size_t i = 0; i < ens_size; i++) retval[i] = offset + double(i % 7) - 3.0;
+  return retval;
+}
+
+template <class T>
+class EnsembleStorage : public TestBase {};
+
+using EnsembleTypes =
+    ::testing::Types<uncertain::EnsembleHeap, uncertain::EnsembleInline, uncertain::EnsemblePooled>;
+TYPED_TEST_SUITE(EnsembleStorage, EnsembleTypes);
+
+TYPED_TEST(EnsembleStorage, Construct) {
+  TypeParam a(2.0, 1.0);
+  EXPECT_DOUBLE_EQ(a.mean(), 2.0);
+  EXPECT_DOUBLE_EQ(a.deviation(), 1.0);
+
+  TypeParam b(3.0);
+  EXPECT_EQ(b.mean(), 3.0);
+  EXPECT_EQ(b.deviation(), 0.0);
+}
+
+TYPED_TEST(EnsembleStorage, SameResultsAsHeap) {
+  uncertain::EnsembleHeap ha(ramp(10.0)), hb(ramp(5.0));
+  TypeParam a(ramp(10.0)), b(ramp(5.0));
+
+  uncertain::EnsembleHeap hc = sqrt(ha * hb + 2.0 * ha) / hb - hb;
+  TypeParam c = sqrt(a * b + 2.0 * a) / b - b;
+  EXPECT_EQ(c.mean(), hc.mean());
+  EXPECT_EQ(c.deviation(), hc.deviation());
+}
+
+TYPED_TEST(EnsembleStorage, CopiesAreIndependent) {
+  TypeParam a(ramp(1.0));
+  TypeParam b(a);
+  TypeParam c;
+  c = a;
+  a += 1.0;
+  EXPECT_DOUBLE_EQ(a.mean(), b.mean() + 1.0);
+  EXPECT_EQ(b.mean(), c.mean());
+  EXPECT_EQ(b.deviation(), c.deviation());
+}
+
+TYPED_TEST(EnsembleStorage, RvalueOperands) {
+  TypeParam a(ramp(10.0)), b(ramp(5.0));
+
+  TypeParam sum = a + (b * 2.0);
+  TypeParam difference = a - (b * 2.0);
+  TypeParam product = a * (b * 2.0);
+  TypeParam quotient = a / (b * 2.0);
+  TypeParam negated = -(b * 2.0);
+  TypeParam reciprocal = 3.0 / (b * 2.0);
+  TypeParam b2(b);
+  b2 *= 2.0;
+
+  EXPECT_EQ(sum.mean(), (a + b2).mean());
+  EXPECT_EQ(difference.mean(), (a - b2).mean());
+  EXPECT_EQ(difference.deviation(), (a - b2).deviation());
+  EXPECT_EQ(product.mean(), (a * b2).mean());
+  EXPECT_EQ(quotient.mean(), (a / b2).mean());
+  EXPECT_EQ(quotient.deviation(), (a / b2).deviation());
+  EXPECT_EQ(negated.mean(), -b2.mean());
+  EXPECT_EQ(reciprocal.mean(), (3.0 / b2).mean());
+  EXPECT_EQ((1.0 - a).mean(), 1.0 - a.mean());
+}
+
+TYPED_TEST(EnsembleStorage, MovedFromIsUsable) {
+  TypeParam a(ramp(1.0));
+  const double mean = a.mean();
+  TypeParam b(std::move(a));
+  a += 1.0;
+  a = 2.0 * b;
+  EXPECT_DOUBLE_EQ(a.mean(), 2.0 * mean);
+  EXPECT_DOUBLE_EQ(b.mean(), mean);
+
+  TypeParam c;
+  c = std::move(b);
+  b = TypeParam(ramp(3.0));
+  EXPECT_DOUBLE_EQ(b.mean(), mean + 2.0);
+  EXPECT_DOUBLE_EQ(c.mean(), mean);
+}
+
+TEST(EnsembleStorage, MovedFromCacheIsEmpty) {
+  uncertain::EnsembleStatsCache a;
+  a.get([] { return uncertain::EnsembleStats{}; });
+  ASSERT_TRUE(a.valid());
+  uncertain::EnsembleStatsCache b(std::move(a));
+  EXPECT_TRUE(b.valid());
+  EXPECT_FALSE(a.valid());
+
+  uncertain::EnsembleStatsCache c;
+  c = std::move(b);
+  EXPECT_TRUE(c.valid());
+  EXPECT_FALSE(b.valid());
+}
+
+TEST(EnsembleStorage, PooledChainReusesStorage) {
+  using Pool = uncertain::EnsemblePool<ens_size>;
+  uncertain::EnsemblePooled a(ramp(1.0)), b(ramp(2.0)), c(ramp(3.0));
+  { uncertain::PooledStorage<ens_size> s1, s2, s3; }
+  size_t cached = Pool::cached();
+  ASSERT_GE(cached, 3u);
+  {
+    // only the two products need new storage; the result keeps one of them
+    uncertain::EnsemblePooled r = a * b + c - b * c / a + 1.0;
+    EXPECT_EQ(Pool::cached(), cached - 1);
+  }
+  EXPECT_EQ(Pool::cached(), cached);
+}
+
+TEST(EnsembleStorage, InlineIsAligned) {
+  uncertain::InlineStorage<ens_size> s;
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(s.data()) % uncertain::kEnsembleAlignment, 0u);
+  EXPECT_EQ(s.size(), ens_size);
+}
+
+TEST(EnsembleStorage, PoolRecyclesBlocks) {
+  using Pool = uncertain::EnsemblePool<ens_size>;
+  const double *first;
+  {
+    uncertain::PooledStorage<ens_size> s;
+    first = s.data();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % uncertain::kEnsembleAlignment, 0u);
+  }
+  size_t cached = Pool::cached();
+  EXPECT_GT(cached, 0u);
+  {
+    uncertain::PooledStorage<ens_size> s;
+    EXPECT_EQ(s.data(), first);
+    EXPECT_EQ(Pool::cached(), cached - 1);
+  }
+  EXPECT_EQ(Pool::cached(), cached);
+}
+
+TEST(EnsembleStorage, PooledMoveTransfersBlock) {
+  uncertain::PooledStorage<ens_size> a;
+  a[0] = 5.0;
+  const double *block = a.data();
+  uncertain::PooledStorage<ens_size> b(std::move(a));
+  EXPECT_EQ(b.data(), block);
+  EXPECT_EQ(b[0], 5.0);
+}
+
+template <class T>
+class MovedFromStorage : public TestBase {};
+
+using StorageTypes =
+    ::testing::Types<uncertain::HeapStorage<ens_size>, uncertain::InlineStorage<ens_size>,
+                     uncertain::PooledStorage<ens_size>>;
+TYPED_TEST_SUITE(MovedFromStorage, StorageTypes);
+
+TYPED_TEST(MovedFromStorage, StillHoldsSamples) {
+  TypeParam a;
+  std::fill(a.begin(), a.end(), 1.0);
+  TypeParam b(std::move(a));
+  ASSERT_NE(a.data(), nullptr);
+  EXPECT_NE(a.data(), b.data());
+  EXPECT_EQ(a.end() - a.begin(), std::ptrdiff_t(ens_size));
+  std::fill(a.begin(), a.end(), 2.0);
+  EXPECT_EQ(b[ens_size - 1], 1.0);
+
+  TypeParam c;
+  c = std::move(b);
+  ASSERT_NE(b.data(), nullptr);
+  std::fill(b.begin(), b.end(), 3.0);
+  EXPECT_EQ(c[0], 1.0);
+  EXPECT_EQ(a[0], 2.0);
+}
+
+TEST(EnsembleStorage, DefaultPolicy) {
+  EXPECT_TRUE((std::is_same_v<uncertain::DefaultEnsembleStorage<128>,
+                              uncertain::InlineStorage<128>>));
+  EXPECT_TRUE((std::is_same_v<uncertain::DefaultEnsembleStorage<1024>,
+                              uncertain::PooledStorage<1024>>));
+}
@@ -10,3 +10,28 @@ TEST(Functions, hypot3) {
 }
 
 TEST(Functions, sqr) { EXPECT_EQ(uncertain::sqr(2), 4); }
+
+TEST(Functions, FunctionTags) {
+  EXPECT_EQ(uncertain::sin_tag{}(0.5), std::sin(0.5));
+  EXPECT_EQ(uncertain::pow_tag{}(2.0, 3.0), 8.0);
+  auto ret = uncertain::sin_w_moments_tag{}(0.5);
+  EXPECT_EQ(ret.value, std::sin(0.5));
+  EXPECT_EQ(ret.arg.slope, std::cos(0.5));
+  EXPECT_EQ(uncertain::atan2_w_moments_tag{}(1.0, 1.0).value, std::atan2(1.0, 1.0));
+}
+
+TEST(Functions, NearDiscontinuity) {
+  using uncertain::discontinuity_type;
+  EXPECT_TRUE(uncertain::near_discontinuity(1.0, 0.5, discontinuity_type::step, 1.0));
+  EXPECT_FALSE(uncertain::near_discontinuity(1.0, 2.0, discontinuity_type::step, 1.0));
+  EXPECT_FALSE(uncertain::near_discontinuity(1.0, 0.5, discontinuity_type::none, 1.0));
+}
+
+TEST(Functions, InverseGaussianDensity) {
+  EXPECT_DOUBLE_EQ(uncertain::inverse_gaussian_density(0.025), 1.959963984540054);
+  EXPECT_DOUBLE_EQ(uncertain::inverse_gaussian_density(1e-10), 6.361340902404056);
+  EXPECT_EQ(uncertain::inverse_gaussian_density(0.5), 0.0);
+  EXPECT_EQ(uncertain::inverse_normal_cdf(0.025), -uncertain::inverse_gaussian_density(0.025));
+  EXPECT_THROW(uncertain::inverse_gaussian_density(0.0), std::runtime_error);
+  EXPECT_THROW(uncertain::inverse_gaussian_density(0.6), std::runtime_error);
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <uncertain/double_ensemble.hpp>
+#include <uncertain/histogram.hpp>
+#include <uncertain/random.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+namespace uncertain {
+
+// the statics are defined with the other tests of the class, in double_ensemble.cpp
+using EnsembleLarge = UDoubleEnsemble<1024>;
+
+template <>
+SourceSet EnsembleLarge::sources;
+
+template <>
+std::vector<std::vector<double>> EnsembleLarge::src_ensemble;
+
+template <>
+std::vector<double> EnsembleLarge::gauss_ensemble;
+
+}  // namespace uncertain
+
+static double uniform(uncertain::Xoshiro256 &engine) { return (engine() >> 11) * 0x1.0p-53; }
+
+TEST(Histogram, Bins) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<double> x = {-1.0, 0.0, 0.4, 0.5, 1.2, 1.999, 2.0, 7.0, nan};
+  uncertain::Histogram h(0.0, 2.0, 4);
+  h.add(x.data(), x.size());
+  EXPECT_EQ(h.bins(), 4u);
+  EXPECT_DOUBLE_EQ(h.bin_width(), 0.5);
+  EXPECT_DOUBLE_EQ(h.bin_center(1), 0.75);
+  EXPECT_EQ(h.below(), 2u);
+  EXPECT_EQ(h.count(0), 2u);
+  EXPECT_EQ(h.count(1), 1u);
+  EXPECT_EQ(h.count(2), 1u);
+  EXPECT_EQ(h.count(3), 1u);
+  EXPECT_EQ(h.above(), 2u);
+  EXPECT_EQ(h.total(), x.size());
+
+  EXPECT_THROW(uncertain::Histogram(1.0, 1.0, 4), std::runtime_error);
+  EXPECT_THROW(uncertain::Histogram(0.0, 1.0, 0), std::runtime_error);
+}
+
+TEST(Histogram, MatchesScalarBinning) {
+  const size_t n = 1000, bins = 13;
+  uncertain::Xoshiro256 engine(3, 0);
+  std::vector<double> x(n);
+  for (double &v : x) v = 4.0 * uniform(engine) - 1.5;
+  uncertain::Histogram h(-1.0, 2.0, bins);
+  h.add(x.data(), n);
+  std::vector<size_t> expected(bins + 2, 0);
+  for (double v : x) {
+    double t = std::floor((v + 1.0) / 3.0 * bins);
+    expected[size_t(std::min(std::max(t + 1.0, 0.0), double(bins) + 1.0))]++;
+  }
+  EXPECT_EQ(h.below(), expected[0]);
+  for (size_t bin = 0; bin < bins; bin++) EXPECT_EQ(h.count(bin), expected[bin + 1]);
+  EXPECT_EQ(h.above(), expected[bins + 1]);
+}
+
+TEST(Histogram, Merge) {
+  std::vector<double> a = {0.1, 0.2, 0.9}, b = {0.3, 0.95, 1.5};
+  uncertain::Histogram ha(0.0, 1.0, 2), hb(0.0, 1.0, 2), both(0.0, 1.0, 2);
+  ha.add(a.data(), a.size());
+  hb.add(b.data(), b.size());
+  both.add(a.data(), a.size());
+  both.add(b.data(), b.size());
+  ha.merge(hb);
+  for (size_t bin = 0; bin < 2; bin++) EXPECT_EQ(ha.count(bin), both.count(bin));
+  EXPECT_EQ(ha.above(), 1u);
+  EXPECT_EQ(ha.total(), 6u);
+  EXPECT_THROW(ha.merge(uncertain::Histogram(0.0, 1.0, 3)), std::runtime_error);
+}
+
+TEST(Histogram, Quantile) {
+  std::vector<double> x;
+  for (size_t i = 0; i < 100; i++) x.push_back((i + 0.5) / 100);
+  uncertain::Histogram h(0.0, 1.0, 10);
+  h.add(x.data(), x.size());
+  EXPECT_DOUBLE_EQ(h.quantile(0.5), 0.5);
+  EXPECT_NEAR(h.quantile(0.25), 0.25, h.bin_width());
+  EXPECT_DOUBLE_EQ(h.quantile(1.0), 1.0);
+  EXPECT_TRUE(std::isnan(uncertain::Histogram(0.0, 1.0, 10).quantile(0.5)));
+}
+
+TEST(Histogram, SampleQuantiles) {
+  const size_t n = 501;
+  uncertain::Xoshiro256 engine(9, 0);
+  std::vector<double> x(n);
+  for (double &v : x) v = uniform(engine);
+  std::vector<double> sorted = x;
+  std::sort(sorted.begin(), sorted.end());
+
+  std::vector<double> probabilities = {0.9, 0.0, 0.5, 0.025, 1.0, 0.5, 0.3337};
+  std::vector<double> q = uncertain::sample_quantiles(x.data(), n, probabilities);
+  for (size_t i = 0; i < probabilities.size(); i++) {
+    double h = (n - 1) * probabilities[i];
+    size_t k = size_t(h);
+    double expected = sorted[k];
+    if (k + 1 < n) expected += (h - k) * (sorted[k + 1] - sorted[k]);
+    EXPECT_DOUBLE_EQ(q[i], expected) << probabilities[i];
+  }
+  std::sort(x.begin(), x.end());
+  EXPECT_EQ(x, sorted);
+
+  EXPECT_THROW(uncertain::sample_quantiles(x.data(), n, {1.5}), std::runtime_error);
+  EXPECT_TRUE(std::isnan(uncertain::sample_quantiles(nullptr, 0, {0.5}).front()));
+}
+
+TEST(Histogram, OfEnsemble) {
+  using uncertain::EnsembleLarge;
+  EnsembleLarge::new_epoch();
+  EnsembleLarge a(uncertain::Uniform(0.0, 1.0)), b(uncertain::Uniform(1.0, 2.0));
+
+  // the basis of a uniform input is stratified, a sample in each 1/1024
+  EXPECT_NEAR(a.quantile(0.5), 0.5, 1e-3);
+  std::pair<double, double> interval = a.credible_interval(0.9);
+  EXPECT_NEAR(interval.first, 0.05, 1e-3);
+  EXPECT_NEAR(interval.second, 0.95, 1e-3);
+  std::vector<double> q = b.quantiles({0.75, 0.25});
+  EXPECT_NEAR(q[0], 1.75, 1e-3);
+  EXPECT_NEAR(q[1], 1.25, 1e-3);
+
+  uncertain::Histogram h = a.histogram(0.0, 2.0, 8);
+  h.merge(b.histogram(0.0, 2.0, 8));
+  EXPECT_EQ(h.total(), 2048u);
+  for (size_t bin = 0; bin < 8; bin++) EXPECT_EQ(h.count(bin), 256u) << bin;
+  EXPECT_NEAR(h.quantile(0.5), 1.0, 0.01);
+}
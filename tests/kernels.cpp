@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cmath>
+#include <uncertain/kernels.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+// odd length so that the vector loops also run their scalar remainder
+static constexpr size_t kernel_test_size = 37;
+
+static std::vector<double> test_values(double lo, double hi) {
+  std::vector<double> v(kernel_test_size);
+  for (size_t i = 0; i < v.size(); i++) v[i] = lo + (hi - lo) * i / (v.size() - 1);
+  return v;
+}
+
+TEST(Kernels, Arithmetic) {
+  auto a = test_values(-3.0, 5.0);
+  auto b = test_values(0.5, 2.0);
+  auto r = a;
+  uncertain::vec_add(r.data(), b.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], a[i] + b[i]);
+  r = a;
+  uncertain::vec_sub(r.data(), b.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], a[i] - b[i]);
+  r = a;
+  uncertain::vec_mul(r.data(), b.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], a[i] * b[i]);
+  r = a;
+  uncertain::vec_div(r.data(), b.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], a[i] / b[i]);
+  r = a;
+  uncertain::vec_mul(r.data(), 3.0, r.size());
+  uncertain::vec_sub(r.data(), 1.0, r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], a[i] * 3.0 - 1.0);
+  r = a;
+  uncertain::vec_negate(r.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], -a[i]);
+}
+
+TEST(Kernels, Reversed) {
+  auto a = test_values(0.5, 2.0);
+  auto b = test_values(-3.0, 5.0);
+  auto r = a;
+  uncertain::vec_rsub(r.data(), b.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], b[i] - a[i]);
+  r = a;
+  uncertain::vec_rdiv(r.data(), b.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], b[i] / a[i]);
+  r = a;
+  uncertain::vec_rsub(r.data(), 2.0, r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], 2.0 - a[i]);
+  r = a;
+  uncertain::vec_rdiv(r.data(), 2.0, r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], 2.0 / a[i]);
+}
+
+TEST(Kernels, Aliased) {
+  auto a = test_values(-3.0, 5.0);
+  auto r = a;
+  uncertain::vec_add(r.data(), r.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_EQ(r[i], 2.0 * a[i]);
+}
+
+TEST(Kernels, MathFunctions) {
+  // vector math libraries are accurate to a few ulp, not correctly rounded
+  auto a = test_values(-1.5, 1.5);
+  auto r = a;
+  uncertain::vec_sin(r.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_DOUBLE_EQ(r[i], std::sin(a[i]));
+  r = a;
+  uncertain::vec_exp(r.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_DOUBLE_EQ(r[i], std::exp(a[i]));
+  r = a;
+  uncertain::vec_atan(r.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_DOUBLE_EQ(r[i], std::atan(a[i]));
+
+  auto p = test_values(0.1, 4.0);
+  r = p;
+  uncertain::vec_log(r.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_DOUBLE_EQ(r[i], std::log(p[i]));
+  r = p;
+  uncertain::vec_pow(r.data(), a.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_DOUBLE_EQ(r[i], std::pow(p[i], a[i]));
+  r = a;
+  uncertain::vec_atan2(r.data(), p.data(), r.size());
+  for (size_t i = 0; i < r.size(); i++) EXPECT_DOUBLE_EQ(r[i], std::atan2(a[i], p[i]));
+}
+
+TEST(Kernels, InverseNormalCdf) {
+  // round trips through the normal distribution function; the lower half
+  // only, where p keeps the full precision
+  std::vector<double> x, p;
+  for (double v = -37.0; v <= 0.0; v += 0.0625) {
+    x.push_back(v);
+    p.push_back(0.5 * std::erfc(-v / std::sqrt(2.0)));
+  }
+  auto q = p;
+  uncertain::vec_inverse_normal_cdf(q.data(), q.size());
+  for (size_t i = 0; i < x.size(); i++)
+    EXPECT_NEAR(q[i], x[i], 1e-14 * std::max(1.0, std::fabs(x[i]))) << p[i];
+
+  // symmetry, a known value, the limits and the range
+  std::vector<double> v = {0.975, 0.025, 0.5, 0.0, 1.0, -0.1, 1.1};
+  uncertain::vec_inverse_normal_cdf(v.data(), v.size());
+  EXPECT_DOUBLE_EQ(v[0], 1.959963984540054);
+  EXPECT_DOUBLE_EQ(v[1], -v[0]);
+  EXPECT_EQ(v[2], 0.0);
+  EXPECT_EQ(v[3], -HUGE_VAL);
+  EXPECT_EQ(v[4], HUGE_VAL);
+  EXPECT_TRUE(std::isnan(v[5]));
+  EXPECT_TRUE(std::isnan(v[6]));
+}
+
+TEST(Kernels, CompensatedSum) {
+  // every lane sees the cancelling large terms, which a naive sum loses
+  std::vector<double> a;
+  for (size_t i = 0; i < kernel_test_size; i++) {
+    a.push_back(1e16);
+    a.push_back(1.0);
+    a.push_back(-1e16);
+  }
+  EXPECT_EQ(uncertain::vec_sum(a.data(), a.size()), double(kernel_test_size));
+  EXPECT_EQ(uncertain::vec_sum(a.data(), 0), 0.0);
+}
+
+TEST(Kernels, PowerSums) {
+  auto a = test_values(-3.0, 5.0);
+  double center = 0.75, sums[5];
+  uncertain::vec_power_sums(a.data(), a.size(), center, 5, sums);
+  for (size_t k = 1; k <= 5; k++) {
+    long double expected = 0.0;
+    for (double x : a) expected += std::pow((long double)(x - center), (long double)k);
+    EXPECT_NEAR(sums[k - 1], double(expected), 1e-12 * std::fabs(double(expected)) + 1e-12);
+  }
+  EXPECT_ANY_THROW(uncertain::vec_power_sums(a.data(), a.size(), center, 6, sums));
+}
+
+TEST(Kernels, MomentSums) {
+  // a large offset makes naive sums of powers lose the spread
+  auto a = test_values(1e8 - 3.0, 1e8 + 5.0);
+  for (size_t i = 0; i < a.size(); i++) a[i] += (i % 3) * 0.25;
+  long double mean = 0.0;
+  for (double x : a) mean += x;
+  mean /= a.size();
+  long double m[6] = {0.0};
+  for (double x : a) {
+    long double diff = x - mean, power = 1.0;
+    for (size_t k = 0; k < 6; k++, power *= diff) m[k] += power;
+  }
+
+  auto sums = uncertain::vec_moment_sums(a.data(), a.size());
+  EXPECT_EQ(sums.count, double(a.size()));
+  EXPECT_DOUBLE_EQ(sums.mean, double(mean));
+  EXPECT_NEAR(sums.m2, double(m[2]), 1e-12 * double(m[2]));
+  EXPECT_NEAR(sums.m3, double(m[3]), 1e-10 * double(m[4]));
+  EXPECT_NEAR(sums.m4, double(m[4]), 1e-12 * double(m[4]));
+  EXPECT_NEAR(sums.m5, double(m[5]), 1e-10 * double(m[4]));
+
+  auto low = uncertain::vec_moment_sums(a.data(), a.size(), 2);
+  EXPECT_DOUBLE_EQ(low.m2, sums.m2);
+  EXPECT_EQ(low.m3, 0.0);
+  EXPECT_EQ(low.m5, 0.0);
+
+  // merging takes the difference of the means, so it keeps the precision
+  // of the spread only while the offset is not much larger
+  auto b = test_values(7.0, 15.0);
+  for (size_t i = 0; i < b.size(); i++) b[i] += (i % 3) * 0.25;
+  auto whole = uncertain::vec_moment_sums(b.data(), b.size());
+  size_t third = b.size() / 3;
+  auto merged = uncertain::vec_moment_sums(b.data(), third);
+  merged.merge(uncertain::vec_moment_sums(b.data() + third, b.size() - third));
+  EXPECT_EQ(merged.count, whole.count);
+  EXPECT_DOUBLE_EQ(merged.mean, whole.mean);
+  EXPECT_NEAR(merged.m2, whole.m2, 1e-12 * whole.m2);
+  EXPECT_NEAR(merged.m3, whole.m3, 1e-12 * whole.m4);
+  EXPECT_NEAR(merged.m4, whole.m4, 1e-12 * whole.m4);
+  EXPECT_NEAR(merged.m5, whole.m5, 1e-12 * whole.m4);
+}
+
+TEST(Kernels, CoMomentSums) {
+  auto a = test_values(-3.0, 5.0);
+  auto b = test_values(1.0, 2.0);
+  for (size_t i = 0; i < b.size(); i++) b[i] = b[i] * b[i] + (i % 5);
+  long double mean_a = 0.0, mean_b = 0.0, m2_a = 0.0, m2_b = 0.0, c = 0.0;
+  for (size_t i = 0; i < a.size(); i++) {
+    mean_a += a[i];
+    mean_b += b[i];
+  }
+  mean_a /= a.size();
+  mean_b /= b.size();
+  for (size_t i = 0; i < a.size(); i++) {
+    m2_a += (a[i] - mean_a) * (a[i] - mean_a);
+    m2_b += (b[i] - mean_b) * (b[i] - mean_b);
+    c += (a[i] - mean_a) * (b[i] - mean_b);
+  }
+
+  // the sums of two parts merge to those of the whole
+  auto sums = uncertain::vec_comoment_sums(a.data(), b.data(), 10);
+  sums.merge(uncertain::vec_comoment_sums(a.data() + 10, b.data() + 10, a.size() - 10));
+  EXPECT_EQ(sums.count, double(a.size()));
+  EXPECT_DOUBLE_EQ(sums.mean_a, double(mean_a));
+  EXPECT_DOUBLE_EQ(sums.mean_b, double(mean_b));
+  EXPECT_DOUBLE_EQ(sums.m2_a, double(m2_a));
+  EXPECT_DOUBLE_EQ(sums.m2_b, double(m2_b));
+  EXPECT_DOUBLE_EQ(sums.c, double(c));
+}
+
+TEST(Kernels, ProjectionSums) {
+  // six rows: a block of four and two left over
+  auto d = test_values(-1.0, 2.0);
+  std::vector<std::vector<double>> rows;
+  std::vector<const double *> pointers;
+  for (int r = 0; r < 6; r++) rows.push_back(test_values(r, 3.0 * r * r + 1.0));
+  for (const auto &row : rows) pointers.push_back(row.data());
+  std::vector<uncertain::ProjectionSums> sums(rows.size());
+  uncertain::vec_projection_sums(d.data(), pointers.data(), rows.size(), d.size(), sums.data());
+  for (size_t r = 0; r < rows.size(); r++) {
+    double sum = 0.0, square = 0.0, cross = 0.0;
+    for (size_t i = 0; i < d.size(); i++) {
+      double t = rows[r][i] - rows[r][0];
+      sum += t;
+      square += t * t;
+      cross += d[i] * t;
+    }
+    EXPECT_DOUBLE_EQ(sums[r].sum, sum);
+    EXPECT_DOUBLE_EQ(sums[r].square, square);
+    EXPECT_DOUBLE_EQ(sums[r].cross, cross);
+  }
+}
@@ -1,7 +1,10 @@
 
 #include <gtest/gtest.h>
+#include <uncertain/ensemble_basis.hpp>
 
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
+  // tests that use the basis cache choose their own directory
+  uncertain::set_gauss_basis_cache_dir("");
   return RUN_ALL_TESTS();
 }
@@ -0,0 +1,165 @@
+#include <cmath>
+#include <uncertain/ms_batch.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+using namespace uncertain;
+
+// odd length so that the vector loops also run their scalar remainder
+static constexpr size_t batch_test_size = 37;
+
+template <bool is_correlated>
+static UDoubleMSBatch<is_correlated> ramp(double lo, double hi, double rel_unc) {
+  UDoubleMSBatch<is_correlated> b;
+  for (size_t i = 0; i < batch_test_size; i++) {
+    double val = lo + (hi - lo) * i / (batch_test_size - 1);
+    b.push_back(UDoubleMS<is_correlated>(val, std::fabs(val) * rel_unc));
+  }
+  return b;
+}
+
+template <bool is_correlated>
+static void expect_same(const UDoubleMSBatch<is_correlated> &b,
+                        const std::vector<UDoubleMS<is_correlated>> &expected) {
+  ASSERT_EQ(b.size(), expected.size());
+  for (size_t i = 0; i < b.size(); i++) {
+    EXPECT_EQ(b.mean(i), expected[i].mean());
+    EXPECT_EQ(b.deviation(i), expected[i].deviation());
+  }
+}
+
+template <bool is_correlated>
+static void expect_near(const UDoubleMSBatch<is_correlated> &b,
+                        const std::vector<UDoubleMS<is_correlated>> &expected) {
+  ASSERT_EQ(b.size(), expected.size());
+  for (size_t i = 0; i < b.size(); i++) {
+    EXPECT_NEAR(b.mean(i), expected[i].mean(), 1e-12 * std::fabs(expected[i].mean()));
+    EXPECT_NEAR(b.deviation(i), expected[i].deviation(),
+                1e-12 * std::fabs(expected[i].deviation()));
+  }
+}
+
+// correlated arithmetic matches UDoubleMS exactly; uncorrelated arithmetic
+// uses a vectorized hypot, which can differ in the last bit
+template <bool is_correlated>
+static void expect_arithmetic(const UDoubleMSBatch<is_correlated> &b,
+                              const std::vector<UDoubleMS<is_correlated>> &expected) {
+  if (is_correlated)
+    expect_same(b, expected);
+  else
+    expect_near(b, expected);
+}
+
+template <bool is_correlated>
+static void check_arithmetic() {
+  using UD = UDoubleMS<is_correlated>;
+  auto a = ramp<is_correlated>(0.5, 2.0, 0.1);
+  auto b = ramp<is_correlated>(-3.0, 5.0, 0.05);
+  std::vector<UD> expected(a.size());
+
+  for (size_t i = 0; i < a.size(); i++) expected[i] = a[i] + b[i] * a[i] - b[i] / a[i];
+  expect_arithmetic(a + b * a - b / a, expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = 2.0 - a[i] * 3.0 + 1.0 / b[i];
+  expect_arithmetic(2.0 - a * 3.0 + 1.0 / b, expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = -(a[i] - 1.5) / 4.0;
+  expect_arithmetic(-(a - 1.5) / 4.0, expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = a[i] - a[i];
+  expect_arithmetic(a - a, expected);
+}
+
+template <bool is_correlated>
+static void check_functions() {
+  using UD = UDoubleMS<is_correlated>;
+  auto a = ramp<is_correlated>(0.1, 0.9, 0.01);
+  auto b = ramp<is_correlated>(1.5, 2.5, 0.02);
+  std::vector<UD> expected(a.size());
+
+  for (size_t i = 0; i < a.size(); i++) expected[i] = exp(sin(a[i])) * log(b[i]) + sqrt(a[i]);
+  expect_near(exp(sin(a)) * log(b) + sqrt(a), expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = acos(a[i]) + asin(a[i]) * atan(b[i]);
+  expect_near(acos(a) + asin(a) * atan(b), expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = tanh(a[i]) + cosh(b[i]) - sinh(a[i]);
+  expect_near(tanh(a) + cosh(b) - sinh(a), expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = pow(b[i], a[i]) + atan2(a[i], b[i]);
+  expect_near(pow(b, a) + atan2(a, b), expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = pow(b[i], 2.0) + pow(2.0, a[i]);
+  expect_near(pow(b, 2.0) + pow(2.0, a), expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = fmod(b[i], 0.7) + fmod(3.0, b[i]);
+  expect_near(fmod(b, 0.7) + fmod(3.0, b), expected);
+  for (size_t i = 0; i < a.size(); i++) expected[i] = floor(b[i]) + ceil(a[i]) + fabs(-a[i]);
+  expect_near(floor(b) + ceil(a) + fabs(-a), expected);
+}
+
+TEST(MSBatch, Construction) {
+  UDoubleMSUncorrBatch b(5, 1.0, 0.5);
+  ASSERT_EQ(b.size(), 5u);
+  EXPECT_EQ(b.mean(4), 1.0);
+  EXPECT_EQ(b.deviation(4), 0.5);
+  EXPECT_ANY_THROW(UDoubleMSUncorrBatch(5, 1.0, -0.5));
+  EXPECT_ANY_THROW(UDoubleMSUncorrBatch({1.0, 2.0}, {0.1, -0.1}));
+  EXPECT_ANY_THROW(UDoubleMSUncorrBatch({1.0, 2.0}, {0.1}));
+  EXPECT_NO_THROW(UDoubleMSCorrBatch({1.0, 2.0}, {0.1, -0.1}));
+  EXPECT_ANY_THROW(b + UDoubleMSUncorrBatch(4));
+
+  b.set(2, UDoubleMSUncorr(3.0, 0.25));
+  EXPECT_EQ(b[2].mean(), 3.0);
+  EXPECT_EQ(b.means()[2], 3.0);
+  EXPECT_EQ(b.raw_uncertainties()[2], 0.25);
+}
+
+TEST(MSBatch, UncorrelatedArithmetic) { check_arithmetic<false>(); }
+
+TEST(MSBatch, CorrelatedArithmetic) { check_arithmetic<true>(); }
+
+TEST(MSBatch, UncorrelatedSumsKeepRange) {
+  // the squares of these overflow or underflow, but not their hypot
+  const double inf = HUGE_VAL;
+  UDoubleMSUncorrBatch a({1.0, 1.0, 1.0, 1.0, 1.0, 1.0}, {3e200, 3e-200, 0.0, inf, inf, 0.5});
+  UDoubleMSUncorrBatch b({2.0, 2.0, 2.0, 2.0, 2.0, 2.0}, {4e200, 4e-200, 0.0, 1.0, inf, 0.0});
+  auto r = a + b;
+  EXPECT_NEAR(r.deviation(0), 5e200, 1e186);
+  EXPECT_NEAR(r.deviation(1), 5e-200, 1e-214);
+  EXPECT_EQ(r.deviation(2), 0.0);
+  EXPECT_EQ(r.deviation(3), inf);
+  EXPECT_EQ(r.deviation(4), inf);
+  EXPECT_EQ(r.deviation(5), 0.5);
+  EXPECT_EQ(r.mean(0), 3.0);
+}
+
+TEST(MSBatch, UncorrelatedFunctions) { check_functions<false>(); }
+
+TEST(MSBatch, CorrelatedFunctions) { check_functions<true>(); }
+
+TEST(MSBatch, Transform) {
+  auto a = ramp<false>(0.5, 2.0, 0.1);
+  auto b = ramp<false>(-3.0, 5.0, 0.05);
+  auto r = transform(a, b, [](const UDoubleMSUncorr &x, const UDoubleMSUncorr &y) {
+    return x * y + sin(x) / (x + 1.0);
+  });
+  std::vector<UDoubleMSUncorr> expected(a.size());
+  for (size_t i = 0; i < a.size(); i++) expected[i] = a[i] * b[i] + sin(a[i]) / (a[i] + 1.0);
+  expect_same(r, expected);
+
+  r = transform(a, [](const UDoubleMSUncorr &x) { return 2.0 * x; });
+  for (size_t i = 0; i < a.size(); i++) expected[i] = 2.0 * a[i];
+  expect_same(r, expected);
+}
+
+TEST(MSBatch, LargeBatchAcrossThreads) {
+  set_num_threads(4);
+  size_t n = 5 * UDoubleMSCorrBatch::kMinChunk + 3;
+  std::vector<double> vals(n), uncs(n);
+  for (size_t i = 0; i < n; i++) {
+    vals[i] = 1.0 + 1e-4 * i;
+    uncs[i] = 1e-3 * (i % 7);
+  }
+  UDoubleMSCorrBatch a(vals, uncs);
+  auto r = a * a - 2.0 / a;
+  for (size_t i = 0; i < n; i++) {
+    UDoubleMSCorr x = a[i], y = x * x - 2.0 / x;
+    ASSERT_EQ(r.mean(i), y.mean());
+    ASSERT_EQ(r.deviation(i), y.deviation());
+  }
+  set_num_threads(0);
+}
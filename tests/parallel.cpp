@@ -0,0 +1,47 @@
+#include <atomic>
+#include <stdexcept>
+#include <uncertain/parallel.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+using namespace uncertain;
+
+TEST(Parallel, CoversEveryIndexOnce) {
+  set_num_threads(4);
+  EXPECT_EQ(get_num_threads(), 4u);
+  for (size_t n : {0, 1, 99, 100, 1001, 12345}) {
+    std::vector<std::atomic<int>> hits(n);
+    parallel_for(n, 50, [&hits](size_t begin, size_t end) {
+      EXPECT_LT(begin, end);
+      for (size_t i = begin; i < end; i++) hits[i]++;
+    });
+    for (size_t i = 0; i < n; i++) ASSERT_EQ(hits[i], 1);
+  }
+  set_num_threads(0);
+  EXPECT_GE(get_num_threads(), 1u);
+}
+
+TEST(Parallel, NestedLoopsRunSerially) {
+  set_num_threads(4);
+  std::atomic<size_t> total{0};
+  parallel_for(1000, 10, [&total](size_t begin, size_t end) {
+    parallel_for(end - begin, 1, [&total](size_t b, size_t e) { total += e - b; });
+  });
+  EXPECT_EQ(total, 1000u);
+  set_num_threads(0);
+}
+
+TEST(Parallel, PropagatesExceptions) {
+  set_num_threads(4);
+  EXPECT_THROW(parallel_for(1000, 10,
+                            [](size_t begin, size_t) {
+                              if (begin > 0) throw std::runtime_error("chunk failed");
+                            }),
+               std::runtime_error);
+  // the pool still works afterwards
+  std::atomic<size_t> total{0};
+  parallel_for(1000, 10, [&total](size_t begin, size_t end) { total += end - begin; });
+  EXPECT_EQ(total, 1000u);
+  set_num_threads(0);
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <uncertain/random.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+using uncertain::Xoshiro256;
+
+TEST(Random, Reproducible) {
+  Xoshiro256 a(42, 7), b(42, 7), other_stream(42, 8), other_seed(43, 7);
+  for (int i = 0; i < 100; i++) {
+    auto x = a();
+    EXPECT_EQ(x, b());
+    EXPECT_NE(x, other_stream());
+    EXPECT_NE(x, other_seed());
+  }
+}
+
+TEST(Random, BelowIsUniform) {
+  Xoshiro256 engine(1);
+  const uint64_t range = 10;
+  const int draws = 100000;
+  std::vector<int> counts(range, 0);
+  for (int i = 0; i < draws; i++) {
+    uint64_t x = engine.below(range);
+    ASSERT_LT(x, range);
+    counts[x]++;
+  }
+  // chi-square with 9 degrees of freedom; 27.9 is the 0.1% tail
+  double chi2 = 0.0, expected = double(draws) / range;
+  for (int c : counts) chi2 += (c - expected) * (c - expected) / expected;
+  EXPECT_LT(chi2, 27.9);
+  EXPECT_EQ(engine.below(1), 0u);
+}
+
+TEST(Random, WorksWithStandardDistributions) {
+  Xoshiro256 engine(3);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double sum = 0.0;
+  for (int i = 0; i < 10000; i++) sum += uniform(engine);
+  EXPECT_NEAR(sum / 10000, 0.5, 0.02);
+}
+
+TEST(Random, ShuffleIsPermutation) {
+  std::vector<double> values(1000);
+  std::iota(values.begin(), values.end(), 0.0);
+  auto shuffled = values;
+  Xoshiro256 engine(5);
+  uncertain::shuffle_values(shuffled.data(), shuffled.size(), engine);
+  EXPECT_NE(shuffled, values);
+  std::sort(shuffled.begin(), shuffled.end());
+  EXPECT_EQ(shuffled, values);
+
+  // every position is equally likely for the first value
+  std::vector<int> position(4, 0);
+  for (int i = 0; i < 40000; i++) {
+    double small[4] = {1.0, 0.0, 0.0, 0.0};
+    uncertain::shuffle_values(small, 4, engine);
+    position[std::find(small, small + 4, 1.0) - small]++;
+  }
+  for (int count : position) EXPECT_NEAR(count, 10000, 400);
+}
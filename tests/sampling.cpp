@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <uncertain/sampling.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+// each of the n slices [i/n, (i+1)/n) holds exactly one of the values
+static bool stratified(std::vector<double> u) {
+  std::sort(u.begin(), u.end());
+  for (size_t i = 0; i < u.size(); i++)
+    if (u[i] * u.size() < i || u[i] * u.size() >= i + 1) return false;
+  return true;
+}
+
+TEST(Sampling, LatinHypercube) {
+  const size_t n = 100;
+  std::vector<double> u(n), v(n);
+  uncertain::Xoshiro256 a(5, 1), b(5, 1), c(5, 2);
+  uncertain::latin_hypercube_uniforms(u.data(), n, a);
+  uncertain::latin_hypercube_uniforms(v.data(), n, b);
+  EXPECT_TRUE(stratified(u));
+  EXPECT_EQ(u, v);
+  uncertain::latin_hypercube_uniforms(v.data(), n, c);
+  EXPECT_TRUE(stratified(v));
+  EXPECT_NE(u, v);
+}
+
+TEST(Sampling, SobolIsStratified) {
+  const size_t n = 256;
+  std::vector<double> u(n), v(n);
+  for (size_t dimension = 0; dimension < 3 * uncertain::kSobolDimensions; dimension++) {
+    uncertain::sobol_uniforms(u.data(), n, dimension, 7);
+    EXPECT_TRUE(stratified(u)) << dimension;
+    uncertain::sobol_uniforms(v.data(), n, dimension, 7);
+    EXPECT_EQ(u, v);
+    uncertain::sobol_uniforms(v.data(), n, dimension, 8);
+    EXPECT_NE(u, v);
+  }
+}
+
+TEST(Sampling, SobolPairsEvenly) {
+  // The first two dimensions of each group form a (0, m, 2)-net: every box
+  // [a/2^k, (a+1)/2^k) x [b/2^(m-k), (b+1)/2^(m-k)) holds one point.
+  const size_t m = 8, n = size_t(1) << m;
+  for (size_t group = 0; group < 2; group++) {
+    size_t first = group * uncertain::kSobolDimensions;
+    std::vector<double> u(n), v(n);
+    uncertain::sobol_uniforms(u.data(), n, first, 3);
+    uncertain::sobol_uniforms(v.data(), n, first + 1, 3);
+    for (size_t k = 0; k <= m; k++) {
+      std::vector<int> counts(n, 0);
+      for (size_t i = 0; i < n; i++) {
+        size_t a = size_t(u[i] * (size_t(1) << k));
+        size_t b = size_t(v[i] * (size_t(1) << (m - k)));
+        counts[(a << (m - k)) | b]++;
+      }
+      EXPECT_EQ(*std::min_element(counts.begin(), counts.end()), 1) << group << " " << k;
+    }
+  }
+}
@@ -0,0 +1,114 @@
+#include <cmath>
+#include <uncertain/double_ct.hpp>
+#include <uncertain/simple_array.hpp>
+#include <uncertain/small_array.hpp>
+
+#include "test_lib/gtest_print.hpp"
+
+namespace uncertain {
+
+using UDoubleCTSM = UDoubleCT<SmallArray<4>>;
+
+template <>
+SourceSet UDoubleCTSM::sources("Small Array");
+
+}  // namespace uncertain
+
+class SmallArrayTest : public TestBase {
+  virtual void SetUp() { uncertain::UDoubleCTSM::new_epoch(); }
+
+  virtual void TearDown() {}
+};
+
+TEST_F(SmallArrayTest, StaysInlineForFewSources) {
+  uncertain::SmallArray<4> a;
+  a.set_element(0, 3.0);
+  a.set_element(3, 4.0);
+  EXPECT_TRUE(a.is_inline());
+  EXPECT_EQ(a[0], 3.0);
+  EXPECT_EQ(a[1], 0.0);
+  EXPECT_EQ(a[3], 4.0);
+  EXPECT_EQ(a[100], 0.0);
+  EXPECT_DOUBLE_EQ(a.norm(), 5.0);
+}
+
+TEST_F(SmallArrayTest, SpillsToHeap) {
+  uncertain::SmallArray<4> a;
+  for (size_t i : {1u, 3u, 5u, 7u}) a.set_element(i, 1.0);
+  EXPECT_TRUE(a.is_inline());
+  a.set_element(9, 4.0);
+  EXPECT_FALSE(a.is_inline());
+  EXPECT_EQ(a.num_nonzero(), 5u);
+  EXPECT_EQ(a[1], 1.0);
+  EXPECT_EQ(a[5], 1.0);
+  EXPECT_EQ(a[6], 0.0);
+  EXPECT_EQ(a[9], 4.0);
+  EXPECT_DOUBLE_EQ(a.norm(), std::sqrt(20.0));
+
+  // back inline once elements cancel
+  uncertain::SmallArray<4> b;
+  b.set_element(3, 1.0);
+  a -= b;
+  EXPECT_TRUE(a.is_inline());
+  EXPECT_EQ(a[3], 0.0);
+  EXPECT_EQ(a[9], 4.0);
+}
+
+TEST_F(SmallArrayTest, HighSourceIds) {
+  // only the elements are stored, not the sources before them
+  uncertain::SmallArray<4> a, b;
+  a.set_element(1000000, 3.0);
+  b.set_element(2000000, 4.0);
+  b.set_element(5, 1.0);
+  a += b;
+  EXPECT_TRUE(a.is_inline());
+  EXPECT_EQ(a.num_nonzero(), 3u);
+  EXPECT_EQ(a[5], 1.0);
+  EXPECT_EQ(a[1000000], 3.0);
+  EXPECT_EQ(a[2000000], 4.0);
+  EXPECT_EQ(a[1500000], 0.0);
+  a.set_element(1000000, 0.0);
+  EXPECT_EQ(a.num_nonzero(), 2u);
+  EXPECT_DOUBLE_EQ(a.norm(), std::sqrt(17.0));
+}
+
+TEST_F(SmallArrayTest, ArithmeticMatchesSimpleArray) {
+  uncertain::SmallArray<4> sa, sb;
+  uncertain::SimpleArray da, db;
+  for (size_t i : {0u, 2u, 6u}) {
+    sa.set_element(i, i + 0.5);
+    da.set_element(i, i + 0.5);
+  }
+  for (size_t i : {1u, 2u, 8u}) {
+    sb.set_element(i, 2.0 * i);
+    db.set_element(i, 2.0 * i);
+  }
+
+  auto sum = sa + sb * 3.0;
+  auto dsum = da + db * 3.0;
+  for (size_t i = 0; i < 9; i++) EXPECT_DOUBLE_EQ(sum[i], dsum[i]) << "at " << i;
+
+  sa -= sb;
+  da -= db;
+  sa /= 2.0;
+  da /= 2.0;
+  for (size_t i = 0; i < 9; i++) EXPECT_DOUBLE_EQ(sa[i], da[i]) << "at " << i;
+  EXPECT_DOUBLE_EQ((-sa).norm(), da.norm());
+}
+
+TEST_F(SmallArrayTest, CorrelatedArithmetic) {
+  uncertain::UDoubleCTSM a(2.0, 1.0);
+  uncertain::UDoubleCTSM b(3.0, 0.5);
+
+  auto c = a + b;
+  EXPECT_DOUBLE_EQ(c.mean(), 5.0);
+  EXPECT_DOUBLE_EQ(c.deviation(), std::hypot(1.0, 0.5));
+
+  auto d = a - a;
+  EXPECT_DOUBLE_EQ(d.mean(), 0.0);
+  EXPECT_DOUBLE_EQ(d.deviation(), 0.0);
+
+  auto e = a / b;
+  EXPECT_DOUBLE_EQ(e.mean(), 2.0 / 3.0);
+  EXPECT_DOUBLE_EQ(e.deviation(), std::hypot(1.0 / 3.0, 0.5 * 2.0 / 9.0));
+}
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <thread>
+#include <uncertain/source_set.hpp>
+#include <vector>
+
+#include "test_lib/gtest_print.hpp"
+
+static constexpr size_t num_threads = 8;
+static constexpr size_t sources_per_thread = 500;
+
+TEST(SourceSet, NamesAndNumbers) {
+  uncertain::SourceSet s("test");
+  EXPECT_EQ(s.get_num_sources(), 0u);
+  EXPECT_EQ(s.get_new_source("a"), 0u);
+  EXPECT_EQ(s.get_new_source("b"), 1u);
+  EXPECT_EQ(s.get_num_sources(), 2u);
+  EXPECT_EQ(s.get_source_name(0), "a");
+  EXPECT_EQ(s.get_source_name(1), "b");
+  EXPECT_ANY_THROW(s.get_source_name(2));
+}
+
+TEST(SourceSet, Epochs) {
+  uncertain::SourceSet s("test");
+  size_t epoch = s.get_epoch();
+  size_t source_epoch;
+  s.get_new_source("a", source_epoch);
+  EXPECT_EQ(source_epoch, epoch);
+  EXPECT_NO_THROW(s.check_epoch(epoch));
+
+  s.new_epoch();
+  EXPECT_ANY_THROW(s.check_epoch(epoch));
+  EXPECT_EQ(s.get_num_sources(), 0u);
+  EXPECT_EQ(s.get_new_source("b", source_epoch), 0u);
+  EXPECT_EQ(source_epoch, epoch + 1);
+  EXPECT_EQ(s.get_source_name(0), "b");
+}
+
+TEST(SourceSet, ConcurrentSources) {
+  uncertain::SourceSet s("test");
+  std::vector<std::vector<size_t>> numbers(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++)
+    threads.emplace_back([&s, &numbers, t] {
+      for (size_t i = 0; i < sources_per_thread; i++)
+        numbers[t].push_back(
+            s.get_new_source("thread " + std::to_string(t) + " source " + std::to_string(i)));
+    });
+  for (auto &thread : threads) thread.join();
+
+  ASSERT_EQ(s.get_num_sources(), num_threads * sources_per_thread);
+  std::vector<size_t> all;
+  for (size_t t = 0; t < num_threads; t++) {
+    // each thread sees its own sources in creation order
+    EXPECT_TRUE(std::is_sorted(numbers[t].begin(), numbers[t].end()));
+    for (size_t i = 0; i < sources_per_thread; i++) {
+      EXPECT_EQ(s.get_source_name(numbers[t][i]),
+                "thread " + std::to_string(t) + " source " + std::to_string(i));
+      all.push_back(numbers[t][i]);
+    }
+  }
+  std::sort(all.begin(), all.end());
+  for (size_t i = 0; i < all.size(); i++) EXPECT_EQ(all[i], i);
+}
+
+TEST(SourceSet, ConcurrentNewEpoch) {
+  uncertain::SourceSet s("test");
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++)
+    threads.emplace_back([&s] {
+      for (size_t i = 0; i < sources_per_thread; i++) {
+        size_t epoch;
+        s.get_new_source("x", epoch);
+      }
+    });
+  for (size_t i = 0; i < 10; i++) s.new_epoch();
+  for (auto &thread : threads) thread.join();
+
+  // every source left belongs to the final epoch and has its name
+  EXPECT_EQ(s.get_epoch(), 10u);
+  for (size_t i = 0; i < s.get_num_sources(); i++) EXPECT_EQ(s.get_source_name(i), "x");
+}
@@ -0,0 +1,92 @@
+#include <uncertain/double_ct.hpp>
+#include <uncertain/simple_array.hpp>
+#include <uncertain/sparse_array.hpp>
+
+#include "test_lib/gtest_print.hpp"
+
+namespace uncertain {
+
+using UDoubleCTSP = UDoubleCT<SparseArray>;
+
+template <>
+SourceSet UDoubleCTSP::sources("Sparse Array");
+
+}  // namespace uncertain
+
+class SparseArrayTest : public TestBase {
+  virtual void SetUp() { uncertain::UDoubleCTSP::new_epoch(); }
+
+  virtual void TearDown() {}
+};
+
+TEST_F(SparseArrayTest, DefaultIsEmpty) {
+  uncertain::SparseArray a;
+  EXPECT_EQ(a.num_nonzero(), 0u);
+  EXPECT_EQ(a[0], 0.0);
+  EXPECT_EQ(a[90000], 0.0);
+  EXPECT_EQ(a.norm(), 0.0);
+}
+
+TEST_F(SparseArrayTest, SetElementKeepsOnlyNonZero) {
+  uncertain::SparseArray a;
+  a.set_element(90000, 4.0);
+  a.set_element(0, 3.0);
+  EXPECT_EQ(a.num_nonzero(), 2u);
+  EXPECT_EQ(a[0], 3.0);
+  EXPECT_EQ(a[1], 0.0);
+  EXPECT_EQ(a[90000], 4.0);
+  EXPECT_DOUBLE_EQ(a.norm(), 5.0);
+
+  a.set_element(0, 0.0);
+  EXPECT_EQ(a.num_nonzero(), 1u);
+  EXPECT_EQ(a[0], 0.0);
+}
+
+TEST_F(SparseArrayTest, MergeMatchesSimpleArray) {
+  uncertain::SparseArray sa, sb;
+  uncertain::SimpleArray da, db;
+  for (size_t i : {1u, 5u, 9u}) {
+    sa.set_element(i, i + 0.5);
+    da.set_element(i, i + 0.5);
+  }
+  for (size_t i : {0u, 5u, 7u, 12u}) {
+    sb.set_element(i, 2.0 * i);
+    db.set_element(i, 2.0 * i);
+  }
+
+  auto sum = sa + sb * 3.0;
+  auto dsum = da + db * 3.0;
+  for (size_t i = 0; i < 13; i++) EXPECT_DOUBLE_EQ(sum[i], dsum[i]) << "at " << i;
+  EXPECT_EQ(sum.num_nonzero(), 5u);
+
+  sa -= sb;
+  da -= db;
+  for (size_t i = 0; i < 13; i++) EXPECT_DOUBLE_EQ(sa[i], da[i]) << "at " << i;
+}
+
+TEST_F(SparseArrayTest, CancellationDropsElement) {
+  uncertain::SparseArray a, b;
+  a.set_element(3, 1.5);
+  b.set_element(3, 1.5);
+  a -= b;
+  EXPECT_EQ(a.num_nonzero(), 0u);
+  EXPECT_EQ(a.norm(), 0.0);
+}
+
+TEST_F(SparseArrayTest, CorrelatedArithmetic) {
+  uncertain::UDoubleCTSP a(2.0, 1.0);
+  uncertain::UDoubleCTSP b(3.0, 0.5);
+
+  auto c = a + b;
+  EXPECT_DOUBLE_EQ(c.mean(), 5.0);
+  EXPECT_DOUBLE_EQ(c.deviation(), std::hypot(1.0, 0.5));
+
+  // fully correlated with itself
+  auto d = a - a;
+  EXPECT_DOUBLE_EQ(d.mean(), 0.0);
+  EXPECT_DOUBLE_EQ(d.deviation(), 0.0);
+
+  auto e = a * b;
+  EXPECT_DOUBLE_EQ(e.mean(), 6.0);
+  EXPECT_DOUBLE_EQ(e.deviation(), std::hypot(1.0 * 3.0, 0.5 * 2.0));
+}